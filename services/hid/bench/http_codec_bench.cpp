@@ -0,0 +1,175 @@
+// Compares the original istringstream/std::map request handling with the
+// in-place HttpRequestView parser and templated response head.
+//
+//   jadeai-hid-bench [iterations]
+
+#include "http_codec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <strings.h>
+
+namespace {
+
+std::atomic<size_t> gAllocations{0};
+std::atomic<size_t> gAllocatedBytes{0};
+volatile size_t gSink = 0;
+
+} // namespace
+
+// Out-of-line so the compiler does not pair the inlined malloc/free itself.
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+constexpr std::string_view kBody{"{\"x\":640,\"y\":360,\"button\":\"left\"}"};
+constexpr std::string_view kResponseBody{"{\"status\":\"ok\"}"};
+
+std::string makeRequest()
+{
+    std::string request;
+    request += "POST /hid/click HTTP/1.1\r\n";
+    request += "Host: jadeai-hid:8003\r\n";
+    request += "User-Agent: jadeai-planner/2.0\r\n";
+    request += "Accept: application/json\r\n";
+    request += "Content-Type: application/json\r\n";
+    request += "Content-Length: " + std::to_string(kBody.size()) + "\r\n";
+    request += "\r\n";
+    request += kBody;
+    return request;
+}
+
+std::string trim(std::string value)
+{
+    const auto notSpace = [](int ch) { return !std::isspace(static_cast<unsigned char>(ch)); };
+    value.erase(value.begin(), std::find_if(value.begin(), value.end(), notSpace));
+    value.erase(std::find_if(value.rbegin(), value.rend(), notSpace).base(), value.end());
+    return value;
+}
+
+// Request handling as it was before the in-place codec.
+size_t legacyHandle(const std::string& data)
+{
+    const auto headerEnd = data.find("\r\n\r\n");
+    std::istringstream headerStream(data.substr(0, headerEnd));
+    std::string requestLine;
+    std::getline(headerStream, requestLine);
+
+    std::map<std::string, std::string> headers;
+    std::string line;
+    size_t contentLength = 0;
+    while (std::getline(headerStream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const auto colon = line.find(':');
+        if (colon != std::string::npos) {
+            auto key = trim(line.substr(0, colon));
+            auto value = trim(line.substr(colon + 1));
+            headers[key] = value;
+            if (strcasecmp(key.c_str(), "Content-Length") == 0) {
+                contentLength = static_cast<size_t>(std::stoul(value));
+            }
+        }
+    }
+    std::string body = data.substr(headerEnd + 4);
+
+    std::istringstream requestLineStream(requestLine);
+    std::string method;
+    std::string target;
+    std::string version;
+    requestLineStream >> method >> target >> version;
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << 200 << ' ' << "OK" << "\r\n";
+    response << "Content-Type: " << "application/json" << "\r\n";
+    response << "Content-Length: " << kResponseBody.size() << "\r\n";
+    response << "Connection: close\r\n\r\n";
+    response << kResponseBody;
+    return response.str().size() + body.size() + contentLength + method.size() + target.size();
+}
+
+// Current path: parse in place over a reused buffer, format the head from templates.
+size_t codecHandle(HttpBuffer& input, HttpRequestView& request, std::string_view data)
+{
+    input.append(data);
+    size_t consumed = 0;
+    if (parseHttpRequest(input.readable(), request, consumed) != HttpParseStatus::Complete) {
+        std::abort();
+    }
+    HttpResponseHead head;
+    head.format(200, "application/json", kResponseBody.size(), request.wantsKeepAlive());
+    const auto size = head.view().size() + kResponseBody.size() + request.body.size() + request.method.size() + request.path.size();
+    input.consume(consumed);
+    return size;
+}
+
+template <typename Fn>
+void run(const char* name, size_t iterations, Fn&& fn)
+{
+    size_t sink = 0;
+    for (size_t i = 0; i < iterations / 10; ++i) {
+        sink += fn();
+    }
+
+    const auto allocationsBefore = gAllocations.load();
+    const auto bytesBefore = gAllocatedBytes.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocations = gAllocations.load() - allocationsBefore;
+    const auto bytes = gAllocatedBytes.load() - bytesBefore;
+
+    const auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+    gSink = sink;
+    std::printf("%-22s %12.1f %14.2f %14.1f\n",
+                name,
+                ns,
+                static_cast<double>(allocations) / static_cast<double>(iterations),
+                static_cast<double>(bytes) / static_cast<double>(iterations));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t iterations = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 200000;
+    const auto request = makeRequest();
+
+    HttpBuffer input;
+    HttpRequestView view;
+
+    std::printf("%-22s %12s %14s %14s\n", "variant", "ns/request", "allocs/request", "bytes/request");
+    run("legacy (sstream/map)", iterations, [&]() { return legacyHandle(request); });
+    run("in-place codec", iterations, [&]() { return codecHandle(input, view, request); });
+    return 0;
+}
@@ -1,10 +1,51 @@
 #pragma once
 
+#include "hid_actions.hpp"
+#include "hid_calibration.hpp"
 #include "hid_config.hpp"
 #include "hid_reports.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <vector>
+
+struct HIDPointerState {
+    int x{0};
+    int y{0};
+    uint8_t buttons{0};
+};
+
+// A pointer destination in latest-wins order: a higher generation replaces
+// the target of a move that is still stepping.
+struct HIDPointerTarget {
+    uint64_t generation{0};
+    int x{0};
+    int y{0};
+};
+
+// Latest time an action may start; nullopt means no limit.
+using HIDDeadline = std::optional<std::chrono::steady_clock::time_point>;
+
+// Thrown by an action whose execution slot was only acquired after its
+// deadline. Nothing has been sent.
+class HIDDeadlineExpired : public std::runtime_error {
+public:
+    HIDDeadlineExpired();
+};
+
+// The report cadence currently in effect. connectionInterval is zero until a
+// connection's parameters have been observed.
+struct HIDPacingState {
+    bool adaptive{false};
+    std::chrono::microseconds connectionInterval{0};
+    std::chrono::microseconds keypressInterval{0};
+    std::chrono::microseconds pointerInterval{0};
+};
 
 class BluetoothHIDServer {
 public:
@@ -14,10 +55,48 @@ public:
     void start();
     void stop();
 
-    void sendText(const std::string& text);
-    void click(int x, int y, MouseButton button = MouseButton::Left);
-    void movePointer(int x, int y);
+    void sendText(const std::string& text, const HIDProgressCallback& progress = {});
+    void click(int x, int y, MouseButton button = MouseButton::Left, const HIDProgressCallback& progress = {});
+    // The actions the datagram server runs take a deadline, checked once the
+    // execution lock is held.
+    void movePointer(int x, int y, const HIDProgressCallback& progress = {}, HIDDeadline deadline = {});
+    // Latest-wins moves. Reserve a target in arrival order, hand it to
+    // movePointer() on the executor, and publish it with retargetPointer()
+    // once the move is accepted: a move still in flight then heads for the
+    // newest target from its next step, and older queued moves are skipped.
+    [[nodiscard]] HIDPointerTarget reservePointerTarget(int x, int y) noexcept;
+    void retargetPointer(const HIDPointerTarget& target);
+    void movePointer(const HIDPointerTarget& target, const HIDProgressCallback& progress = {});
+    void moveRelative(int dx, int dy, HIDDeadline deadline = {});
+    // Raw keyboard reports by HID usage; setKey(0, 0) releases all keys.
+    void tapKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline = {});
+    void setKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline = {});
+    void setButton(MouseButton button, bool pressed, HIDDeadline deadline = {});
+    void scroll(int delta, HIDDeadline deadline = {});
+    // Releases every key and mouse button.
+    void releaseAll();
+    // Calibration probe for relative mode: `reports` reports of `step`
+    // counts along +x, paced like a move. Returns the counts sent.
+    int probePointer(int step, int reports, const HIDProgressCallback& progress = {});
+    std::vector<HIDActionTiming> executeBatch(const std::vector<HIDAction>& actions, const HIDProgressCallback& progress = {});
+
+    // Expected wall-clock time to run the actions with the configured pacing.
+    [[nodiscard]] std::chrono::microseconds estimateDuration(const std::vector<HIDAction>& actions) const;
+    [[nodiscard]] HIDPointerState pointerState() const noexcept;
+    [[nodiscard]] HIDPacingState pacingState() const noexcept;
+
+    // Relative moves are planned through the host's measured acceleration
+    // while a calibration is set; nullptr restores 1:1 counts to pixels.
+    void setPointerCalibration(std::shared_ptr<const HIDPointerCalibration> calibration);
+    [[nodiscard]] std::shared_ptr<const HIDPointerCalibration> pointerCalibration() const;
 
+    // Called on the executing thread, with the execution lock held, after
+    // each typed character, key tap, pointer step, click and scroll step, and
+    // during batch waits. Typing may still hold the last key there; text
+    // resumes correctly if the hook releases it. The hook may run further
+    // actions on this server or throw to abort the current one. Must be set
+    // before start().
+    void setReportBoundaryHook(std::function<void()> hook);
     [[nodiscard]] bool isRunning() const noexcept;
 
 private:
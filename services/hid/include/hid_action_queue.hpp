@@ -0,0 +1,185 @@
+#pragma once
+
+#include "hid_actions.hpp"
+#include "hid_config.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class HIDJobState {
+    Queued,
+    Running,
+    Succeeded,
+    Failed,
+    Cancelled
+};
+
+std::string_view jobStateName(HIDJobState state);
+
+// Execution lanes. A job may preempt any running job of a lower priority at
+// the next report boundary.
+enum class HIDPriority {
+    Low,
+    Normal,
+    High
+};
+
+inline constexpr size_t kHIDPriorityCount = 3;
+
+std::string_view priorityName(HIDPriority priority);
+HIDPriority priorityFromString(std::string_view name);
+
+enum class HIDJobEvent {
+    Started,
+    Progress,
+    Finished
+};
+
+struct HIDJobSnapshot {
+    uint64_t id{0};
+    std::string kind;
+    HIDPriority priority{HIDPriority::Normal};
+    HIDJobState state{HIDJobState::Queued};
+    size_t progressDone{0};
+    size_t progressTotal{0};
+    std::chrono::microseconds queued{0};
+    std::chrono::microseconds running{0};
+    std::string result;
+    std::string error;
+
+    [[nodiscard]] bool finished() const noexcept { return state >= HIDJobState::Succeeded; }
+};
+
+// Thrown by submit()/post() when admitting the task would exceed the queue's
+// depth or estimated-drain limits.
+class HIDQueueFullError : public std::runtime_error {
+public:
+    HIDQueueFullError(const std::string& message, std::chrono::milliseconds retryAfter);
+
+    [[nodiscard]] std::chrono::milliseconds retryAfter() const noexcept { return retryAfter_; }
+
+private:
+    std::chrono::milliseconds retryAfter_;
+};
+
+// Thrown out of checkpoint() into a running task whose job was cancelled.
+class HIDJobCancelled : public std::runtime_error {
+public:
+    HIDJobCancelled();
+};
+
+// Runs HID actions as jobs on a dedicated executor thread so that report
+// pacing never blocks socket I/O. Jobs run highest lane first and in
+// submission order within a lane; finished jobs are retained for status
+// queries up to a fixed count. Each task carries an estimated cost so the
+// queue can refuse work it could not start within jobs.max_queue_delay_ms.
+//
+// Tasks call checkpoint() at every report boundary. That is where a
+// cancelled job is aborted and where higher-lane jobs run to completion,
+// nested on the executor thread, before the interrupted task resumes.
+class HIDActionQueue {
+public:
+    using Task = std::function<std::string(const HIDProgressCallback&)>;
+    using Completion = std::function<void(const HIDJobSnapshot&)>;
+    using Observer = std::function<void(HIDJobEvent, const HIDJobSnapshot&)>;
+    using InterruptHook = std::function<void()>;
+
+    explicit HIDActionQueue(const HIDJobsConfig& config);
+    ~HIDActionQueue();
+
+    HIDActionQueue(const HIDActionQueue&) = delete;
+    HIDActionQueue& operator=(const HIDActionQueue&) = delete;
+
+    // Receives lifecycle events for jobs with an ID, on the executor thread.
+    // With listeners, Started and Progress events are only built while it is
+    // nonzero, so progress ticks cost nothing when nobody is watching.
+    // Must be set before start().
+    void setObserver(Observer observer, const std::atomic<size_t>* listeners = nullptr);
+    // Runs on the executor thread before a running task is preempted or
+    // aborted, e.g. to release held keys. Must be set before start().
+    void setInterruptHook(InterruptHook hook);
+
+    void start();
+    void stop();
+
+    uint64_t submit(std::string kind, HIDPriority priority, std::chrono::microseconds cost, Task task, Completion completion = {});
+    // Runs a task in order with Normal-lane jobs but without a job ID or
+    // retained status; for high-rate streams where per-message records would
+    // only churn.
+    void post(std::chrono::microseconds cost, Task task, Completion completion);
+    [[nodiscard]] std::optional<HIDJobSnapshot> find(uint64_t id) const;
+    bool watch(uint64_t id, Completion completion);
+    // Removes a queued job, or asks a running one to stop at its next
+    // checkpoint. Returns false if the job is unknown or already finished.
+    bool cancel(uint64_t id);
+
+    // No-op unless called from a task on the executor thread.
+    void checkpoint();
+
+    [[nodiscard]] size_t depth() const;
+    // Estimated time until everything queued now has finished.
+    [[nodiscard]] std::chrono::microseconds backlog() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        uint64_t id{0};
+        std::string kind;
+        HIDPriority priority{HIDPriority::Normal};
+        Task task;
+        std::chrono::microseconds cost{0};
+        std::atomic<bool> cancelRequested{false};
+        std::vector<Completion> watchers;
+        HIDJobState state{HIDJobState::Queued};
+        std::atomic<size_t> progressDone{0};
+        std::atomic<size_t> progressTotal{0};
+        Clock::time_point submitted;
+        Clock::time_point started;
+        Clock::time_point finished;
+        std::string result;
+        std::string error;
+    };
+
+    void enqueue(std::shared_ptr<Job> job);
+    std::chrono::microseconds backlogLocked(Clock::time_point now, HIDPriority from) const;
+    std::shared_ptr<Job> takeNextLocked(HIDPriority from);
+    void run();
+    void execute(const std::shared_ptr<Job>& job);
+    void finish(const std::shared_ptr<Job>& job, HIDJobState state, std::string result, std::string error);
+    HIDJobSnapshot snapshot(const Job& job) const;
+
+    const size_t retainFinished_;
+    const size_t maxDepth_;
+    const std::chrono::microseconds maxDelay_;
+    Observer observer_;
+    const std::atomic<size_t>* listeners_{nullptr};
+    InterruptHook interruptHook_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<std::deque<std::shared_ptr<Job>>, kHIDPriorityCount> pending_;
+    std::array<std::chrono::microseconds, kHIDPriorityCount> pendingCost_{};
+    std::unordered_map<uint64_t, std::shared_ptr<Job>> jobs_;
+    std::deque<uint64_t> finishedOrder_;
+    // Innermost last; more than one entry while a preempting job runs.
+    std::vector<std::shared_ptr<Job>> active_;
+    uint64_t nextJobId_{1};
+    std::thread worker_;
+    bool running_{false};
+};
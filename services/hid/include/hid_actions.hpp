@@ -0,0 +1,39 @@
+#pragma once
+
+#include "hid_reports.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class HIDActionType {
+    Click,
+    Move,
+    Text,
+    Wait
+};
+
+struct HIDAction {
+    HIDActionType type{HIDActionType::Wait};
+    int x{0};
+    int y{0};
+    MouseButton button{MouseButton::Left};
+    std::string text;
+    uint32_t waitMs{0};
+};
+
+struct HIDActionTiming {
+    std::chrono::microseconds offset{0};
+    std::chrono::microseconds duration{0};
+};
+
+// Reports units of work completed so far: characters typed, pointer reports
+// sent or batch steps finished, depending on the operation.
+using HIDProgressCallback = std::function<void(size_t done, size_t total)>;
+
+std::string_view actionTypeName(HIDActionType type);
+HIDActionType actionTypeFromString(std::string_view name);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+// One probe measurement: `reports` relative reports of `step` counts each
+// moved the host cursor `pixels` along the probed axis.
+struct HIDGainSample {
+    int step{0};
+    int reports{0};
+    int pixels{0};
+};
+
+// How far one relative report of a given size moves a particular host's
+// cursor once its pointer acceleration is applied. Built from probe
+// measurements and held as a lookup table over every report size, which the
+// trajectory planner inverts to choose counts for a wanted pixel distance.
+class HIDPointerCalibration {
+public:
+    static constexpr int kMaxStep = 127;
+    static constexpr int kMaxProbeReports = 1000;
+    static constexpr int kMaxProbePixels = 1000000;
+
+    // Throws std::invalid_argument unless the samples describe a gain that
+    // grows strictly with step size.
+    HIDPointerCalibration(std::string host, std::vector<HIDGainSample> samples);
+
+    [[nodiscard]] const std::string& host() const noexcept { return host_; }
+    [[nodiscard]] const std::vector<HIDGainSample>& samples() const noexcept { return samples_; }
+
+    // Pixels moved by one report of `counts` (signed, clamped to the report range).
+    [[nodiscard]] double pixelsFor(int counts) const noexcept;
+    // The report size, within +/-maxStep, whose movement is closest to `pixels`.
+    [[nodiscard]] int countsFor(double pixels, int maxStep) const noexcept;
+
+    // Profiles persist as small YAML documents, one per host.
+    static HIDPointerCalibration load(const std::string& path);
+    void save(const std::string& path) const;
+
+private:
+    std::string host_;
+    std::vector<HIDGainSample> samples_;
+    // Pixels per report, indexed by counts.
+    std::array<double, kMaxStep + 1> table_{};
+};
+
+// Host names become file names, so they are limited to [A-Za-z0-9._-].
+bool isValidCalibrationHost(const std::string& host) noexcept;
@@ -1,15 +1,38 @@
 #pragma once
 
+#include "hid_keyboard_layout.hpp"
+#include "hid_trajectory.hpp"
+
 #include <cstdint>
 #include <string>
 
 struct HTTPConfig {
     std::string bindAddress{"0.0.0.0"};
     uint16_t port{8003};
+    bool tcpEnabled{true};
+    std::string unixSocket;
+    uint32_t unixSocketMode{0660};
+    uint32_t reactorThreads{1};
+    uint32_t backlog{128};
+    uint32_t maxRequestBytes{65536};
+    uint32_t keepAliveTimeoutMs{5000};
+    uint32_t maxRequestsPerConnection{1000};
+};
+
+struct HIDKeyboardConfig {
+    bool enabled{true};
+    HIDKeyboardLayout layout{HIDKeyboardLayout::US};
+    // Bound on compiled report sequences kept for repeated texts; 0 disables.
+    uint32_t textCacheBytes{262144};
 };
 
-struct HIDInputConfig {
+// In absolute mode the pointer is driven through the absolute report (ID 3)
+// and pixel coordinates are scaled from the screen size onto its range.
+struct HIDMouseConfig {
     bool enabled{true};
+    bool absolute{false};
+    uint32_t screenWidth{1920};
+    uint32_t screenHeight{1080};
 };
 
 struct HIDDeviceIdentity {
@@ -21,17 +44,49 @@ struct HIDDeviceIdentity {
 };
 
 struct HIDSafetyConfig {
-    uint32_t keypressDelayMs{20};
-    uint32_t mouseMoveDelayMs{5};
+    uint32_t keypressDelayUs{20000};
+    uint32_t mouseMoveDelayUs{5000};
     uint32_t mouseStepLimit{50};
+    HIDTrajectoryProfile pointerProfile{HIDTrajectoryProfile::Linear};
+    // Pace reports at the host's negotiated connection interval instead of
+    // the fixed delays above, but never faster than minReportIntervalUs.
+    bool adaptivePacing{false};
+    uint32_t minReportIntervalUs{7500};
+};
+
+struct HIDJobsConfig {
+    uint32_t retainFinished{256};
+    uint32_t maxWaitMs{30000};
+    uint32_t maxQueueDepth{64};
+    uint32_t maxQueueDelayMs{10000};
+};
+
+struct HIDDatagramConfig {
+    std::string bindAddress{"127.0.0.1"};
+    uint16_t udpPort{0};
+    std::string unixSocket;
+    uint32_t unixSocketMode{0660};
+
+    [[nodiscard]] bool enabled() const noexcept { return udpPort != 0 || !unixSocket.empty(); }
+};
+
+struct HIDCalibrationConfig {
+    // Where pointer calibration profiles are stored, one <host>.yml each;
+    // empty keeps them in memory only.
+    std::string directory;
+    // Profile activated at startup, if it exists.
+    std::string host;
 };
 
 struct HIDConfig {
     HIDDeviceIdentity device;
     HTTPConfig http;
-    HIDInputConfig keyboard;
-    HIDInputConfig mouse;
+    HIDKeyboardConfig keyboard;
+    HIDMouseConfig mouse;
     HIDSafetyConfig safety;
+    HIDJobsConfig jobs;
+    HIDDatagramConfig datagram;
+    HIDCalibrationConfig calibration;
 
     [[nodiscard]] std::string adapterPath() const { return "/org/bluez/" + device.adapter; }
 };
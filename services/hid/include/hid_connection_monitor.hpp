@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Follows the LE connection parameters the host negotiates with the adapter.
+// BlueZ does not publish the connection interval over D-Bus, so this listens
+// on a raw HCI socket for LE Connection Complete / Connection Update Complete
+// and Disconnection Complete events. Needs CAP_NET_RAW; without it the
+// interval simply stays unknown. Connections that predate start() are not
+// seen until their parameters next change.
+class HIDConnectionMonitor {
+public:
+    HIDConnectionMonitor() = default;
+    ~HIDConnectionMonitor();
+
+    HIDConnectionMonitor(const HIDConnectionMonitor&) = delete;
+    HIDConnectionMonitor& operator=(const HIDConnectionMonitor&) = delete;
+
+    // adapter is a BlueZ adapter name such as "hci0".
+    void start(const std::string& adapter);
+    void stop();
+
+    // The longest interval among live connections, i.e. the cadence at
+    // which every connected host can take one report per connection event.
+    [[nodiscard]] std::optional<std::chrono::microseconds> interval() const noexcept;
+
+private:
+    void run();
+    void handleEvent(const uint8_t* packet, size_t size);
+    void publish();
+
+    int socketFd_{-1};
+    int wakeFd_{-1};
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::unordered_map<uint16_t, std::chrono::microseconds> connections_;
+    std::atomic<int64_t> intervalUs_{0};
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "bluetooth_hid_server.hpp"
+#include "hid_config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Fixed 16-byte little-endian command datagram:
+//
+//   offset  type  field
+//        0  u8    version (kHIDDatagramVersion)
+//        1  u8    opcode
+//        2  u16   reserved, must be zero
+//        4  u32   sequence number; 0 starts a new session for the sender
+//        8  i16   a: dx | x | button | wheel delta | key usage
+//       10  i16   b: dy | y | pressed | unused      | key modifiers
+//       12  u32   ttl_us: drop unless started within this long of arrival; 0 = none
+//
+// Stats requests are answered with a datagram of the same header followed by
+// the HIDDatagramStats counters as seven little-endian u64 values.
+inline constexpr uint8_t kHIDDatagramVersion = 1;
+inline constexpr size_t kHIDDatagramSize = 16;
+
+enum class HIDDatagramOpcode : uint8_t {
+    MoveRelative = 0x01,
+    MoveAbsolute = 0x02,
+    Button = 0x03,
+    Wheel = 0x04,
+    KeyTap = 0x05,
+    KeyDown = 0x06,
+    KeyUp = 0x07,
+    Stats = 0x7F
+};
+
+struct HIDDatagramCommand {
+    HIDDatagramOpcode opcode{HIDDatagramOpcode::Stats};
+    uint32_t seq{0};
+    int16_t a{0};
+    int16_t b{0};
+    uint32_t ttlUs{0};
+};
+
+bool decodeHIDDatagram(const uint8_t* data, size_t size, HIDDatagramCommand& command) noexcept;
+
+struct HIDDatagramStats {
+    uint64_t received{0};
+    uint64_t accepted{0};
+    uint64_t malformed{0};
+    uint64_t reordered{0};
+    uint64_t lost{0};
+    uint64_t expired{0};
+    uint64_t failed{0};
+};
+
+// Receives HID commands over UDP and/or a Unix datagram socket and executes
+// them on its own thread. Sequence numbers are tracked per sender: late or
+// duplicate datagrams are dropped as reordered and gaps are counted as lost.
+//
+// Commands call the BluetoothHIDServer directly rather than going through
+// the HTTP action queue: they wait for the execution lock behind a running
+// job (expiring if their TTL passes first), never preempt it at a report
+// boundary, and cannot be cancelled as jobs.
+class HIDDatagramServer {
+public:
+    HIDDatagramServer(BluetoothHIDServer& hid, const HIDConfig& config);
+    ~HIDDatagramServer();
+
+    HIDDatagramServer(const HIDDatagramServer&) = delete;
+    HIDDatagramServer& operator=(const HIDDatagramServer&) = delete;
+
+    void start();
+    void stop();
+
+    [[nodiscard]] HIDDatagramStats stats() const noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int openUdpSocket() const;
+    int openUnixSocket() const;
+    void closeSockets();
+
+    void run();
+    void drain(int fd);
+    bool acceptSequence(const std::string& sender, uint32_t seq);
+    void execute(const HIDDatagramCommand& command, HIDDeadline deadline);
+
+    BluetoothHIDServer& hid_;
+    HIDDatagramConfig config_;
+
+    int udpFd_{-1};
+    int unixFd_{-1};
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::unordered_map<std::string, uint32_t> lastSeq_;
+};
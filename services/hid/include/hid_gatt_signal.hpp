@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The PropertiesChanged signal a characteristic emits when its Value
+// changes: (interface, {"Value": <ay>}, []). The names and signatures are
+// built once, and the body is written element by element instead of through
+// a std::map of Variants, so emitting a report allocates nothing on our side.
+// Message is sdbus::Signal in the service.
+class HIDValueChangedSignal {
+public:
+    HIDValueChangedSignal(std::string_view propertiesInterface, std::string_view characteristicInterface)
+        : propertiesInterface_(propertiesInterface)
+        , characteristicInterface_(characteristicInterface)
+    {
+    }
+
+    [[nodiscard]] const std::string& interfaceName() const noexcept { return propertiesInterface_; }
+    [[nodiscard]] const std::string& memberName() const noexcept { return member_; }
+
+    template <typename Message>
+    void append(Message& message, const uint8_t* data, size_t size) const
+    {
+        message << characteristicInterface_;
+        message.openContainer(changedSignature_);
+        message.openDictEntry(entrySignature_);
+        message << valueName_;
+        message.openVariant(valueSignature_);
+        message.openContainer(byteSignature_);
+        for (size_t i = 0; i < size; ++i) {
+            message << data[i];
+        }
+        message.closeContainer();
+        message.closeVariant();
+        message.closeDictEntry();
+        message.closeContainer();
+        message.openContainer(invalidatedSignature_);
+        message.closeContainer();
+    }
+
+private:
+    std::string propertiesInterface_;
+    std::string characteristicInterface_;
+    std::string member_{"PropertiesChanged"};
+    std::string valueName_{"Value"};
+    std::string changedSignature_{"{sv}"};
+    std::string entrySignature_{"sv"};
+    std::string valueSignature_{"ay"};
+    std::string byteSignature_{"y"};
+    std::string invalidatedSignature_{"s"};
+};
+
+// A characteristic's stored value, shared between BlueZ reads and the output
+// thread. Input report characteristics reserve a report-sized buffer before
+// registration so update() never reallocates.
+class HIDCharacteristicValue {
+public:
+    void reserve(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_.reserve(capacity);
+    }
+
+    void set(const std::vector<uint8_t>& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_.assign(value.begin(), value.end());
+    }
+
+    [[nodiscard]] std::vector<uint8_t> get() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return value_;
+    }
+
+    // The per-report step of a notification: stores the value in place and,
+    // given a message, writes the PropertiesChanged body for it. The caller
+    // only creates and emits the message around this.
+    template <typename Message>
+    void update(const uint8_t* data, size_t size, const HIDValueChangedSignal& signal, Message* message)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            value_.assign(data, data + size);
+        }
+        if (message) {
+            signal.append(*message, data, size);
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> value_;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "hid_reports.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+// The host-side keyboard layout text is typed for. The usages sent are
+// physical key positions, so they must match the layout the host has
+// selected for the device. Tables follow the standard Windows variants.
+enum class HIDKeyboardLayout {
+    US,
+    UK,
+    DE,
+    FR
+};
+
+std::string_view keyboardLayoutName(HIDKeyboardLayout layout);
+HIDKeyboardLayout keyboardLayoutFromString(std::string_view name);
+
+// Constant-time table lookup; characters the layout cannot type come back
+// unmapped.
+[[nodiscard]] HIDLayoutKey lookupKeyboardKey(HIDKeyboardLayout layout, char32_t codePoint) noexcept;
+
+// Decodes the UTF-8 sequence at pos and advances past it. A malformed,
+// overlong or truncated sequence consumes one byte and yields U+FFFD.
+[[nodiscard]] char32_t decodeUtf8(std::string_view text, size_t& pos) noexcept;
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class MetricCounter {
+public:
+    void add(uint64_t amount = 1) noexcept { value_.fetch_add(amount, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class MetricGauge {
+public:
+    void set(int64_t value) noexcept { value_.store(value, std::memory_order_relaxed); }
+    [[nodiscard]] int64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Fixed-bucket latency histogram from 50 us to 10 s. Observations touch only
+// relaxed atomics, so a concurrent scrape may see a bucket and the count a
+// few observations apart but never blocks the recorder.
+class LatencyHistogram {
+public:
+    static constexpr std::array<uint64_t, 17> kBoundsUs{
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+    void observe(std::chrono::nanoseconds elapsed) noexcept;
+    void render(std::string& out, std::string_view name, std::string_view labels) const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBoundsUs.size() + 1> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sumNs_{0};
+};
+
+enum class HIDEndpoint : uint8_t {
+    Healthz,
+    Metrics,
+    Text,
+    Click,
+    Move,
+    Batch,
+    Jobs,
+    Stream,
+    Events,
+    Release,
+    Calibration,
+    Unknown,
+    Count
+};
+
+enum class HIDReportChannel : uint8_t {
+    Keyboard,
+    BootKeyboard,
+    Mouse,
+    BootMouse,
+    AbsolutePointer,
+    Count
+};
+
+inline constexpr size_t kEndpointCount = static_cast<size_t>(HIDEndpoint::Count);
+inline constexpr size_t kReportChannelCount = static_cast<size_t>(HIDReportChannel::Count);
+
+std::string_view endpointName(HIDEndpoint endpoint);
+std::string_view reportChannelName(HIDReportChannel channel);
+
+struct HIDDatagramCounters {
+    MetricCounter received;
+    MetricCounter accepted;
+    MetricCounter malformed;
+    MetricCounter reordered;
+    MetricCounter lost;
+    MetricCounter expired;
+    MetricCounter failed;
+};
+
+// Where each input report went: the report- or boot-protocol characteristic,
+// stored without a signal because the host subscribed to neither, or
+// dropped because boot protocol has no format for it.
+struct HIDReportRouteCounters {
+    MetricCounter report;
+    MetricCounter boot;
+    MetricCounter unsubscribed;
+    MetricCounter dropped;
+};
+
+struct HIDMetrics {
+    // Indexed by endpoint, then status class (1xx..5xx).
+    std::array<std::array<MetricCounter, 5>, kEndpointCount> requests;
+    std::array<LatencyHistogram, kEndpointCount> requestLatency;
+
+    LatencyHistogram executionWait;
+    std::array<LatencyHistogram, kReportChannelCount> notifyDuration;
+    std::array<MetricCounter, kReportChannelCount> reports;
+    std::array<MetricGauge, kReportChannelCount> notifying;
+    MetricCounter unsupportedCharacters;
+    MetricCounter textCacheHits;
+    MetricCounter textCacheMisses;
+    MetricGauge textCacheBytes;
+    MetricCounter queueRejections;
+    LatencyHistogram pacingSlip;
+    MetricCounter pacingResyncs;
+    MetricCounter pointerRetargets;
+    MetricCounter pointerSuperseded;
+
+    HIDDatagramCounters datagram;
+    HIDReportRouteCounters routes;
+
+    void recordRequest(HIDEndpoint endpoint, int statusCode, std::chrono::nanoseconds elapsed) noexcept;
+    void render(std::string& out) const;
+};
+
+HIDMetrics& hidMetrics();
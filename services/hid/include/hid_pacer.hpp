@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+
+// Computes absolute CLOCK_MONOTONIC due times for a sequence of reports so
+// that emission time and wake-up latency do not accumulate across the
+// sequence; the output thread sleeps until each due time. Not thread-safe;
+// owned by whoever holds the execution lock.
+class HIDPacer {
+public:
+    [[nodiscard]] static std::chrono::nanoseconds now() noexcept;
+    // Returns the wake-up time.
+    static std::chrono::nanoseconds sleepUntil(std::chrono::nanoseconds deadline) noexcept;
+
+    // Anchors the schedule at the current time, unless the previous sequence's
+    // last interval has not elapsed yet.
+    void restart() noexcept;
+
+    [[nodiscard]] std::chrono::nanoseconds due() const noexcept { return deadline_; }
+
+    // Moves the next due time `interval` past the previous one. A schedule
+    // that has fallen more than one interval behind (a stall, or a preempting
+    // job) is re-anchored at the current time rather than caught up with a
+    // burst.
+    void advance(std::chrono::nanoseconds interval) noexcept;
+
+private:
+    std::chrono::nanoseconds deadline_{0};
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "hid_metrics.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// One preformatted input report, due on its characteristic at an absolute
+// CLOCK_MONOTONIC time.
+struct HIDReportRecord {
+    HIDReportChannel channel{HIDReportChannel::Keyboard};
+    uint8_t size{0};
+    std::array<uint8_t, 9> bytes{};
+    std::chrono::nanoseconds due{0};
+};
+
+// Bounded lock-free multi-producer/single-consumer ring of report records.
+// Producers claim slots with a CAS on the tail and publish them through a
+// per-slot sequence number; the single output thread pops in claim order.
+// Every record gets a ticket so producers can wait until the output thread
+// has retired (emitted) everything up to a given report.
+//
+// After close() the consumer still drains every slot claimed so far, and
+// producers fail fast with HIDReportRingClosed instead of waiting on it.
+class HIDReportRingClosed : public std::runtime_error {
+public:
+    HIDReportRingClosed();
+};
+
+class HIDReportRing {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    HIDReportRing() noexcept;
+
+    HIDReportRing(const HIDReportRing&) = delete;
+    HIDReportRing& operator=(const HIDReportRing&) = delete;
+
+    // Blocks while the ring is full. Returns the record's ticket; throws
+    // HIDReportRingClosed once the ring is closed.
+    uint64_t push(const HIDReportRecord& record);
+    // Consumer only. Blocks until a record is available; returns false once
+    // the ring is closed and every claimed slot has been popped.
+    bool pop(HIDReportRecord& record);
+    // Consumer only: marks the last popped record as emitted.
+    void retire() noexcept;
+    void close() noexcept;
+
+    // Throws HIDReportRingClosed if the ring is closed before the ticket is
+    // retired.
+    void awaitRetired(uint64_t ticket) const;
+    [[nodiscard]] uint64_t lastTicket() const noexcept { return tail_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "capacity must be a power of two");
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        HIDReportRecord record;
+    };
+
+    bool tryPush(const HIDReportRecord& record, uint64_t& ticket) noexcept;
+    bool tryPop(HIDReportRecord& record) noexcept;
+
+    std::array<Slot, kCapacity> slots_;
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> published_{0};
+    alignas(64) std::atomic<uint64_t> retired_{0};
+    alignas(64) uint64_t head_{0};
+    std::atomic<bool> closed_{false};
+};
@@ -16,11 +16,51 @@ struct HIDKeyboardStroke {
     uint8_t modifiers{0};
 };
 
-std::optional<HIDKeyboardStroke> lookupKeyboardStroke(char ch);
+// How a layout types one character: stroke, preceded by a dead key when the
+// character is composed (dead.usage != 0). stroke.usage == 0 means the
+// layout cannot type it.
+struct HIDLayoutKey {
+    HIDKeyboardStroke dead;
+    HIDKeyboardStroke stroke;
+
+    [[nodiscard]] constexpr bool mapped() const noexcept { return stroke.usage != 0; }
+};
 
 std::array<uint8_t, 9> makeKeyboardReport(uint8_t modifiers, uint8_t keycode);
 const std::array<uint8_t, 9>& makeKeyboardReleaseReport();
 
+// Compiles typed characters into keyboard reports, one per character where
+// possible. Each key is pressed while the previous one is still held in a
+// second rollover slot and released by the report after it, so a host sees
+// exactly one new key per report and keeps the typed order. Modifiers change
+// in the same report as the key that needs them, so Shift stays down across
+// a run of shifted characters. Only a repeated key costs an extra report, to
+// release it first.
+class HIDTypingEncoder {
+public:
+    struct Reports {
+        std::array<std::array<uint8_t, 9>, 4> data{};
+        size_t count{0};
+    };
+
+    // Continue from the report the host last received, e.g. after something
+    // else released the keys mid-text.
+    void resync(const std::array<uint8_t, 9>& current) noexcept { report_ = current; }
+
+    [[nodiscard]] Reports type(HIDKeyboardStroke stroke) noexcept;
+    // Types the dead key, if any, then the stroke.
+    [[nodiscard]] Reports type(const HIDLayoutKey& key) noexcept;
+    // The report that releases everything, if anything is held.
+    [[nodiscard]] std::optional<std::array<uint8_t, 9>> finish() noexcept;
+
+private:
+    std::array<uint8_t, 9> report_{makeKeyboardReleaseReport()};
+};
+
 std::array<uint8_t, 5> makeMouseReport(uint8_t buttons, int8_t dx, int8_t dy, int8_t wheel = 0);
+
+// Logical range of both axes of the absolute pointer report.
+inline constexpr uint16_t kAbsolutePointerMax = 32767;
+std::array<uint8_t, 6> makeAbsolutePointerReport(uint8_t buttons, uint16_t x, uint16_t y);
 uint8_t mouseButtonMask(MouseButton button);
 MouseButton mouseButtonFromString(const std::string& name);
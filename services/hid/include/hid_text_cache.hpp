@@ -0,0 +1,61 @@
+#pragma once
+
+#include "hid_keyboard_layout.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The keyboard reports that type a UTF-8 string on a layout from an
+// all-keys-up state, as HIDTypingEncoder produces them, stored contiguously.
+// steps[i] marks where the reports for the i-th typed character end and how
+// many bytes of the text that accounts for, for progress.
+struct HIDCompiledText {
+    struct Step {
+        uint32_t reportsEnd{0};
+        uint32_t done{0};
+    };
+
+    std::vector<std::array<uint8_t, 9>> reports;
+    std::vector<Step> steps;
+    // Characters skipped because no key mapping exists.
+    size_t unsupported{0};
+
+    [[nodiscard]] size_t bytes() const noexcept;
+};
+
+HIDCompiledText compileText(const std::string& text, HIDKeyboardLayout layout);
+
+// LRU of texts compiled for one layout, bounded by their total size; a
+// capacity of zero compiles every time. Thread-safe.
+class HIDTextCache {
+public:
+    HIDTextCache(size_t capacityBytes, HIDKeyboardLayout layout);
+
+    // Returns the cached sequence or compiles and caches it. Only recorded
+    // lookups count towards the hit and miss metrics; the first recorded
+    // lookup of an entry cached by an unrecorded one counts as a miss.
+    std::shared_ptr<const HIDCompiledText> get(const std::string& text, bool record = true);
+
+private:
+    struct Entry {
+        std::string text;
+        std::shared_ptr<const HIDCompiledText> compiled;
+        size_t bytes{0};
+        bool recorded{false};
+    };
+
+    const size_t capacity_;
+    const HIDKeyboardLayout layout_;
+    std::mutex mutex_;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    size_t bytes_{0};
+};
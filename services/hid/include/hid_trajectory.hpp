@@ -0,0 +1,44 @@
+#pragma once
+
+#include "hid_calibration.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// How a relative pointer move is split into reports.
+enum class HIDTrajectoryProfile {
+    // Equal steps on the dominant axis with the minor axis spread evenly, so
+    // both axes arrive together in the fewest reports the step limit allows.
+    Linear,
+    // Minimum-jerk velocity profile: slow start and finish, peak speed
+    // mid-move. Takes about 1.9x the reports of Linear at the same limit.
+    MinimumJerk
+};
+
+std::string_view trajectoryProfileName(HIDTrajectoryProfile profile);
+HIDTrajectoryProfile trajectoryProfileFromString(std::string_view name);
+
+// dx/dy are the report's counts; pixelsX/pixelsY the cursor movement they
+// are expected to produce, which differs from the counts only when the
+// host's acceleration is calibrated.
+struct HIDPointerStep {
+    int8_t dx{0};
+    int8_t dy{0};
+    int pixelsX{0};
+    int pixelsY{0};
+};
+
+// Replaces steps with the relative reports that move the pointer by (dx, dy)
+// pixels without any report exceeding maxStep counts on either axis. maxStep
+// is clamped to the 1..127 a report can carry. With a calibration the path
+// is planned in pixels, limited to what a maxStep report moves, and each
+// step's counts come from inverting the host's gain, carrying the rounding
+// error forward so the move still ends on target.
+void planTrajectory(HIDTrajectoryProfile profile, int dx, int dy, int maxStep, std::vector<HIDPointerStep>& steps,
+                    const HIDPointerCalibration* calibration = nullptr);
+
+// The number of reports planTrajectory() would produce.
+[[nodiscard]] size_t trajectoryLength(HIDTrajectoryProfile profile, int dx, int dy, int maxStep,
+                                      const HIDPointerCalibration* calibration = nullptr);
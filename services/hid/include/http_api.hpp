@@ -1,11 +1,17 @@
 #pragma once
 
 #include "bluetooth_hid_server.hpp"
+#include "hid_action_queue.hpp"
 #include "hid_config.hpp"
+#include "http_codec.hpp"
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
-#include <thread>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 class HIDHttpApi {
 public:
@@ -16,14 +22,38 @@ public:
     void stop();
 
 private:
-    void serverLoop();
-    void handleClient(int clientFd);
+    struct Connection;
+    class Reactor;
+
+    int openListener(bool reusePort) const;
+    int openUnixListener() const;
+    void closeUnixListener();
+    void handleRequest(Reactor& reactor, Connection& connection, const HttpRequestView& request);
+    void respondQueueFull(Reactor& reactor, Connection& connection, const HIDQueueFullError& ex);
+    void respondAccepted(Reactor& reactor, Connection& connection, const HttpRequestView& request, uint64_t jobId);
+    void handleJobCancel(Reactor& reactor, Connection& connection, const HttpRequestView& request);
+    void handleJobQuery(Reactor& reactor, Connection& connection, const HttpRequestView& request);
+    void handleCalibration(Reactor& reactor, Connection& connection, const HttpRequestView& request);
+    std::string storeCalibration(const std::string& host, std::shared_ptr<const HIDPointerCalibration> calibration, int& status);
+    std::string calibrationPath(const std::string& host) const;
+    void loadStartupCalibration();
+    void publishJobEvent(HIDJobEvent event, const HIDJobSnapshot& job);
+    void handleStreamMessage(Reactor& reactor, Connection& connection, std::string_view payload);
     std::string buildJsonResponse(const std::string& status, const std::string& detail = {}) const;
-    void sendResponse(int clientFd, int statusCode, const std::string& reason, const std::string& body, const std::string& contentType = "application/json") const;
+    std::string buildStreamAck(std::optional<int64_t> seq) const;
+    std::string buildStreamError(std::optional<int64_t> seq, const std::string& detail) const;
+    std::string buildJobEvent(HIDJobEvent event, const HIDJobSnapshot& job);
+    std::string buildJobResponse(const HIDJobSnapshot& job) const;
+    std::string buildCalibrationResponse(const HIDPointerCalibration& calibration) const;
+    std::string buildBatchResponse(const std::vector<HIDAction>& actions, const std::vector<HIDActionTiming>& timings) const;
 
     BluetoothHIDServer& hid_;
     HIDConfig config_;
-    std::thread serverThread_;
+    HIDActionQueue actions_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    int unixListenFd_{-1};
     std::atomic<bool> running_{false};
-    int serverFd_{-1};
+    std::atomic<uint64_t> nextEventId_{1};
+    // Open event streams across all reactors.
+    std::atomic<size_t> eventSubscribers_{0};
 };
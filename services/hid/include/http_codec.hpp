@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct HttpHeaderView {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Non-owning view of a request parsed in place; every field points into the
+// connection buffer and is only valid until that buffer is consumed.
+struct HttpRequestView {
+    static constexpr size_t kMaxHeaders = 32;
+
+    std::string_view method;
+    std::string_view target;
+    std::string_view path;
+    std::string_view query;
+    std::string_view version;
+    std::string_view body;
+    std::array<HttpHeaderView, kMaxHeaders> headers{};
+    size_t headerCount{0};
+    size_t contentLength{0};
+
+    [[nodiscard]] std::optional<std::string_view> header(std::string_view name) const;
+    [[nodiscard]] bool headerHasToken(std::string_view name, std::string_view token) const;
+    [[nodiscard]] std::optional<std::string_view> queryParam(std::string_view name) const;
+    [[nodiscard]] bool wantsKeepAlive() const;
+};
+
+enum class HttpParseStatus {
+    Incomplete,
+    Complete,
+    Invalid
+};
+
+HttpParseStatus parseHttpRequest(std::string_view buffer, HttpRequestView& request, size_t& consumed);
+
+// Growable byte buffer with separate read and write cursors. Consumed bytes are
+// reclaimed by compaction so a connection reuses one allocation for its lifetime.
+class HttpBuffer {
+public:
+    [[nodiscard]] std::string_view readable() const noexcept { return {data_.data() + begin_, end_ - begin_}; }
+    [[nodiscard]] size_t size() const noexcept { return end_ - begin_; }
+    [[nodiscard]] bool empty() const noexcept { return begin_ == end_; }
+
+    char* prepare(size_t minimum);
+    [[nodiscard]] size_t writable() const noexcept { return data_.size() - end_; }
+    void commit(size_t count) noexcept { end_ += count; }
+    void append(std::string_view bytes);
+    void consume(size_t count) noexcept;
+    void clear() noexcept { begin_ = end_ = 0; }
+
+private:
+    std::vector<char> data_;
+    size_t begin_{0};
+    size_t end_{0};
+};
+
+// Response status line and headers rendered from preformatted templates into
+// inline storage; the body is written separately with scatter/gather I/O.
+// kCapacity covers every head the service sends, the largest being a 202
+// with Location or a 429 with Retry-After at under 200 bytes. A longer head
+// is rendered into heap storage rather than truncated.
+class HttpResponseHead {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    // extraHeaders, if given, must be complete "Name: value\r\n" lines.
+    void format(int statusCode, std::string_view contentType, size_t contentLength, bool keepAlive,
+                std::string_view extraHeaders = {});
+
+    [[nodiscard]] std::string_view view() const noexcept { return {data(), size_}; }
+
+private:
+    [[nodiscard]] const char* data() const noexcept { return overflow_.empty() ? buffer_.data() : overflow_.data(); }
+    void append(std::string_view bytes) noexcept;
+
+    std::array<char, kCapacity> buffer_{};
+    std::string overflow_;
+    size_t size_{0};
+};
+
+std::string_view httpStatusText(int statusCode);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "hid_actions.hpp"
+#include "hid_calibration.hpp"
+#include "hid_reports.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonDecodeError : public std::invalid_argument {
+public:
+    JsonDecodeError(const std::string& message, size_t offset);
+
+    [[nodiscard]] size_t offset() const noexcept { return offset_; }
+
+private:
+    size_t offset_;
+};
+
+// Strict single-pass pull reader over a JSON document. Callers walk the
+// document in the order they expect it; anything else is a JsonDecodeError
+// carrying the byte offset of the problem.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view input) noexcept : input_(input) {}
+
+    void beginObject();
+    bool nextField(std::string_view& name);
+    void beginArray();
+    bool nextElement();
+
+    std::string readString();
+    int64_t readInteger(int64_t min, int64_t max);
+    bool readBool();
+
+    void finish();
+
+    [[noreturn]] void fail(const std::string& message) const;
+    [[noreturn]] void rejectField(std::string_view reason) const;
+
+private:
+    void skipWhitespace() noexcept;
+    void expect(char ch);
+    bool consumeIf(char ch);
+    void appendUtf8(std::string& out, uint32_t codepoint) const;
+    uint32_t readHex4();
+
+    std::string_view input_;
+    std::string_view field_;
+    size_t pos_{0};
+    bool atContainerStart_{false};
+};
+
+struct TextCommand {
+    std::string text;
+};
+
+struct PointerCommand {
+    int x{0};
+    int y{0};
+    MouseButton button{MouseButton::Left};
+};
+
+enum class StreamMessageType {
+    Move,
+    Button,
+    Wheel
+};
+
+// One message on the /hid/stream WebSocket. seq is echoed in the acknowledgment.
+struct StreamMessage {
+    StreamMessageType type{StreamMessageType::Move};
+    std::optional<int64_t> seq;
+    int x{0};
+    int y{0};
+    MouseButton button{MouseButton::Left};
+    bool pressed{false};
+    int delta{0};
+};
+
+// PUT /hid/calibration. Without samples it selects a stored profile.
+struct CalibrationCommand {
+    std::string host;
+    std::optional<std::vector<HIDGainSample>> samples;
+};
+
+struct ProbeCommand {
+    int step{0};
+    int reports{0};
+};
+
+TextCommand decodeTextCommand(std::string_view json);
+PointerCommand decodeClickCommand(std::string_view json);
+PointerCommand decodeMoveCommand(std::string_view json);
+std::vector<HIDAction> decodeBatchCommand(std::string_view json);
+StreamMessage decodeStreamMessage(std::string_view json);
+CalibrationCommand decodeCalibrationCommand(std::string_view json);
+ProbeCommand decodeProbeCommand(std::string_view json);
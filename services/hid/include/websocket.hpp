@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class WebSocketOpcode : uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA
+};
+
+// Client frame parsed in place. The payload is still masked; use
+// unmaskWebSocketPayload to copy it out.
+struct WebSocketFrame {
+    WebSocketOpcode opcode{WebSocketOpcode::Continuation};
+    bool fin{false};
+    std::array<uint8_t, 4> mask{};
+    std::string_view payload;
+};
+
+enum class WebSocketParseStatus {
+    Incomplete,
+    Complete,
+    Invalid
+};
+
+// Accepts only masked client frames without extensions (RFC 6455 section 5.2).
+WebSocketParseStatus parseWebSocketFrame(std::string_view buffer, WebSocketFrame& frame, size_t& consumed);
+void unmaskWebSocketPayload(const WebSocketFrame& frame, std::string& out);
+
+// Unmasked server frame header; the payload is sent separately.
+class WebSocketFrameHeader {
+public:
+    WebSocketFrameHeader(WebSocketOpcode opcode, size_t payloadSize) noexcept;
+
+    [[nodiscard]] std::string_view view() const noexcept { return {buffer_.data(), size_}; }
+
+private:
+    std::array<char, 10> buffer_{};
+    size_t size_{0};
+};
+
+std::string webSocketAcceptKey(std::string_view clientKey);
+std::string webSocketHandshakeResponse(std::string_view clientKey);
@@ -1,19 +1,30 @@
 #include "bluetooth_hid_server.hpp"
 
+#include "hid_connection_monitor.hpp"
+#include "hid_gatt_signal.hpp"
+#include "hid_keyboard_layout.hpp"
+#include "hid_metrics.hpp"
+#include "hid_pacer.hpp"
+#include "hid_report_ring.hpp"
 #include "hid_reports.hpp"
+#include "hid_text_cache.hpp"
+#include "hid_trajectory.hpp"
 
 #include <sdbus-c++/sdbus-c++.h>
 
 #include <algorithm>
-#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <thread>
 #include <utility>
@@ -44,6 +55,8 @@ constexpr std::string_view kMouseInputReportPath{ "/org/jadeai/hid/service0/char
 constexpr std::string_view kMouseInputReportRefPath{ "/org/jadeai/hid/service0/char5/desc0" };
 constexpr std::string_view kBootKeyboardInputPath{ "/org/jadeai/hid/service0/char6" };
 constexpr std::string_view kBootMouseInputPath{ "/org/jadeai/hid/service0/char7" };
+constexpr std::string_view kAbsolutePointerInputPath{ "/org/jadeai/hid/service0/char8" };
+constexpr std::string_view kAbsolutePointerInputRefPath{ "/org/jadeai/hid/service0/char8/desc0" };
 
 constexpr std::string_view kDeviceInfoServicePath{ "/org/jadeai/hid/service1" };
 constexpr std::string_view kManufacturerCharPath{ "/org/jadeai/hid/service1/char0" };
@@ -51,6 +64,8 @@ constexpr std::string_view kPnPIdCharPath{ "/org/jadeai/hid/service1/char1" };
 
 constexpr std::string_view kAdvertisementPath{ "/org/jadeai/hid/advertisement0" };
 
+constexpr auto kWaitSlice = std::chrono::milliseconds(10);
+
 constexpr std::string_view kHidServiceUuid{ "00001812-0000-1000-8000-00805f9b34fb" };
 constexpr std::string_view kDeviceInfoServiceUuid{ "0000180a-0000-1000-8000-00805f9b34fb" };
 constexpr std::string_view kHidInfoUuid{ "00002a4a-0000-1000-8000-00805f9b34fb" };
@@ -69,7 +84,9 @@ constexpr uint8_t kProtocolReportMode = 0x01;
 
 std::vector<uint8_t> hidReportMap()
 {
-    // Keyboard (Report ID 1) + Mouse (Report ID 2)
+    // Keyboard (Report ID 1) + Mouse (Report ID 2) + absolute pointer (Report ID 3).
+    // The absolute pointer is always described so that switching
+    // hid.mouse.mode does not change the GATT database a bonded host caches.
     return {
         0x05, 0x01,       // Usage Page (Generic Desktop)
         0x09, 0x06,       // Usage (Keyboard)
@@ -123,6 +140,34 @@ std::vector<uint8_t> hidReportMap()
         0x95, 0x03,
         0x81, 0x06,       //     Input (Data, Var, Rel)
         0xC0,
+        0xC0,
+
+        0x05, 0x01,       // Usage Page (Generic Desktop)
+        0x09, 0x02,       // Usage (Mouse)
+        0xA1, 0x01,       // Collection (Application)
+        0x85, 0x03,       //   Report ID (3)
+        0x09, 0x01,       //   Usage (Pointer)
+        0xA1, 0x00,       //   Collection (Physical)
+        0x05, 0x09,       //     Usage Page (Buttons)
+        0x19, 0x01,
+        0x29, 0x03,
+        0x15, 0x00,
+        0x25, 0x01,
+        0x95, 0x03,
+        0x75, 0x01,
+        0x81, 0x02,       //     Input (Data, Var, Abs)
+        0x95, 0x01,
+        0x75, 0x05,
+        0x81, 0x01,       //     Input (Const)
+        0x05, 0x01,
+        0x09, 0x30,       //     Usage (X)
+        0x09, 0x31,       //     Usage (Y)
+        0x15, 0x00,       //     Logical minimum (0)
+        0x26, 0xFF, 0x7F, //     Logical maximum (32767)
+        0x75, 0x10,
+        0x95, 0x02,
+        0x81, 0x02,       //     Input (Data, Var, Abs)
+        0xC0,
         0xC0
     };
 }
@@ -138,6 +183,12 @@ std::vector<uint8_t> makePnPId()
     return {0x02, 0xD4, 0x04, 0x34, 0x12, 0x01, 0x00};
 }
 
+const HIDValueChangedSignal& valueChangedSignal()
+{
+    static const HIDValueChangedSignal signal{kPropertiesInterface, kGattCharacteristicInterface};
+    return signal;
+}
+
 class ManagedObject {
 public:
     virtual ~ManagedObject() = default;
@@ -240,8 +291,7 @@ public:
                 if (readHandler_) {
                     return readHandler_(options);
                 }
-                std::lock_guard<std::mutex> lock(valueMutex_);
-                return value_;
+                return value_.get();
             });
 
         object_->registerMethod("WriteValue")
@@ -251,8 +301,7 @@ public:
                 if (writeHandler_) {
                     writeHandler_(value, options);
                 } else {
-                    std::lock_guard<std::mutex> lock(valueMutex_);
-                    value_ = value;
+                    value_.set(value);
                 }
             });
 
@@ -260,6 +309,7 @@ public:
             .onInterface(kGattCharacteristicInterface.data())
             .implementedAs([this]() {
                 notifying_ = true;
+                publishNotifying();
                 if (notifyHandler_) {
                     notifyHandler_(true);
                 }
@@ -269,6 +319,7 @@ public:
             .onInterface(kGattCharacteristicInterface.data())
             .implementedAs([this]() {
                 notifying_ = false;
+                publishNotifying();
                 if (notifyHandler_) {
                     notifyHandler_(false);
                 }
@@ -292,10 +343,7 @@ public:
 
         object_->registerProperty("Value")
             .onInterface(kGattCharacteristicInterface.data())
-            .withGetter([this]() {
-                std::lock_guard<std::mutex> lock(valueMutex_);
-                return value_;
-            });
+            .withGetter([this]() { return value_.get(); });
 
         object_->finishRegistration();
     }
@@ -309,17 +357,13 @@ public:
         props.insert({"Service", sdbus::ObjectPath{servicePath_}});
         props.insert({"Flags", flags_});
         props.insert({"Descriptors", descriptorPaths_});
-        {
-            std::lock_guard<std::mutex> lock(valueMutex_);
-            props.insert({"Value", value_});
-        }
+        props.insert({"Value", value_.get()});
         return {{std::string{kGattCharacteristicInterface}, std::move(props)}};
     }
 
     void setInitialValue(const std::vector<uint8_t>& value)
     {
-        std::lock_guard<std::mutex> lock(valueMutex_);
-        value_ = value;
+        value_.set(value);
     }
 
     void addDescriptor(const std::shared_ptr<GattDescriptor>& descriptor)
@@ -328,30 +372,51 @@ public:
         descriptorPaths_.push_back(sdbus::ObjectPath{descriptor->path()});
     }
 
-    void updateValue(const std::vector<uint8_t>& value, bool notify)
+    // Report-sized values fit the buffer reserved by setReportChannel(), so
+    // neither the store nor the signal body allocates here; the allocation
+    // test in tests/ covers HIDCharacteristicValue::update().
+    void updateValue(const uint8_t* data, size_t size, bool notify)
     {
-        {
-            std::lock_guard<std::mutex> lock(valueMutex_);
-            value_ = value;
+        const auto start = std::chrono::steady_clock::now();
+        const auto& changed = valueChangedSignal();
+        if (!notify || !notifying_) {
+            value_.update<sdbus::Signal>(data, size, changed, nullptr);
+            return;
         }
-        if (notify && notifying_) {
-            auto signal = object_->createSignal(kPropertiesInterface.data(), "PropertiesChanged");
-            std::map<std::string, sdbus::Variant> changed;
-            changed.insert({"Value", value});
-            std::vector<std::string> invalidated;
-            signal << std::string{kGattCharacteristicInterface} << changed << invalidated;
-            object_->emitSignal(signal);
+        auto signal = object_->createSignal(changed.interfaceName(), changed.memberName());
+        value_.update(data, size, changed, &signal);
+        object_->emitSignal(signal);
+        if (reportChannel_ != HIDReportChannel::Count) {
+            auto& metrics = hidMetrics();
+            const auto index = static_cast<size_t>(reportChannel_);
+            metrics.reports[index].add();
+            metrics.notifyDuration[index].observe(std::chrono::steady_clock::now() - start);
         }
     }
 
-    void notifyValue(const std::vector<uint8_t>& value)
+    void notifyValue(const uint8_t* data, size_t size)
     {
-        updateValue(value, true);
+        updateValue(data, size, true);
     }
 
     bool notifying() const { return notifying_; }
 
+    // Attributes notifications on this characteristic to an input report
+    // channel in the metrics. Must be called before registration with BlueZ.
+    void setReportChannel(HIDReportChannel channel)
+    {
+        reportChannel_ = channel;
+        value_.reserve(HIDReportRecord{}.bytes.size());
+    }
+
 private:
+    void publishNotifying()
+    {
+        if (reportChannel_ != HIDReportChannel::Count) {
+            hidMetrics().notifying[static_cast<size_t>(reportChannel_)].set(notifying_ ? 1 : 0);
+        }
+    }
+
     sdbus::IConnection& connection_;
     std::string path_;
     std::string uuid_;
@@ -365,9 +430,9 @@ private:
     std::vector<sdbus::ObjectPath> descriptorPaths_;
     std::vector<std::weak_ptr<GattDescriptor>> descriptors_;
 
-    mutable std::mutex valueMutex_;
-    std::vector<uint8_t> value_;
+    HIDCharacteristicValue value_;
     std::atomic<bool> notifying_{false};
+    HIDReportChannel reportChannel_{HIDReportChannel::Count};
 };
 
 class GattService : public ManagedObject, public std::enable_shared_from_this<GattService> {
@@ -472,6 +537,11 @@ std::vector<uint8_t> toVector(const std::array<uint8_t, 5>& array)
     return std::vector<uint8_t>(array.begin(), array.end());
 }
 
+std::vector<uint8_t> toVector(const std::array<uint8_t, 6>& array)
+{
+    return std::vector<uint8_t>(array.begin(), array.end());
+}
+
 } // namespace
 
 class BluetoothHIDServer::Impl {
@@ -500,6 +570,15 @@ public:
         setupAdvertisement();
         registerWithBlueZ();
 
+        {
+            std::lock_guard<std::recursive_mutex> execution(executionMutex_);
+            ring_ = std::make_unique<HIDReportRing>();
+        }
+        outputThread_ = std::thread([this]() { runOutput(); });
+        if (config_.safety.adaptivePacing) {
+            connectionMonitor_.start(config_.device.adapter);
+        }
+
         running_ = true;
         eventThread_ = std::thread([this]() {
             try {
@@ -517,6 +596,20 @@ public:
             return;
         }
 
+        // Closing first makes a running action fail at its next report
+        // instead of holding the execution lock until it finishes; the ring
+        // is then destroyed under that lock, where producers reach it.
+        connectionMonitor_.stop();
+        ring_->close();
+        if (outputThread_.joinable()) {
+            outputThread_.join();
+        }
+        {
+            std::lock_guard<std::recursive_mutex> execution(executionMutex_);
+            ring_.reset();
+            lastTicket_ = 0;
+        }
+
         try {
             unregisterFromBlueZ();
         } catch (const std::exception& ex) {
@@ -543,54 +636,543 @@ public:
         return running_;
     }
 
-    void sendText(const std::string& text)
+    void sendText(const std::string& text, const HIDProgressCallback& progress)
+    {
+        requireKeyboard();
+        const auto lock = lockExecution();
+        sendTextInternal(text, progress);
+    }
+
+    void movePointer(int x, int y, const HIDProgressCallback& progress, HIDDeadline deadline)
+    {
+        requireMouse();
+        const auto lock = lockExecution(deadline);
+        movePointerInternal(x, y, progress);
+    }
+
+    HIDPointerTarget reservePointerTarget(int x, int y) noexcept
+    {
+        return {nextTargetGeneration_.fetch_add(1, std::memory_order_relaxed) + 1, x, y};
+    }
+
+    void retargetPointer(const HIDPointerTarget& target)
+    {
+        const std::lock_guard<std::mutex> lock(targetMutex_);
+        if (target.generation > pointerTarget_.generation) {
+            pointerTarget_ = target;
+        }
+    }
+
+    // A move whose target has already been replaced by a newer one does
+    // nothing: the newer target is being, or will be, followed instead.
+    void movePointer(const HIDPointerTarget& target, const HIDProgressCallback& progress)
+    {
+        requireMouse();
+        const auto lock = lockExecution();
+        retargetPointer(target);
+        {
+            const std::lock_guard<std::mutex> targetLock(targetMutex_);
+            if (pointerTarget_.generation != target.generation) {
+                hidMetrics().pointerSuperseded.add();
+                return;
+            }
+        }
+        movePointerInternal(target.x, target.y, progress, true);
+    }
+
+    void click(int x, int y, MouseButton button, const HIDProgressCallback& progress)
+    {
+        requireMouse();
+        const auto lock = lockExecution();
+        clickInternal(x, y, button, progress);
+    }
+
+    void moveRelative(int dx, int dy, HIDDeadline deadline)
+    {
+        requireMouse();
+        const auto lock = lockExecution(deadline);
+        movePointerInternal(lastPointerX_ + dx, lastPointerY_ + dy, {});
+    }
+
+    void tapKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline)
+    {
+        requireKeyboard();
+        const auto lock = lockExecution(deadline);
+        tapKeyInternal(modifiers, usage);
+    }
+
+    void setKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline)
+    {
+        requireKeyboard();
+        const auto lock = lockExecution(deadline);
+        sendKeyboardReport(makeKeyboardReport(modifiers, usage));
+    }
+
+    int probePointer(int step, int reports, const HIDProgressCallback& progress)
+    {
+        requireMouse();
+        if (config_.mouse.absolute) {
+            throw std::runtime_error("Pointer calibration only applies to hid.mouse.mode relative");
+        }
+        const auto lock = lockExecution();
+        const auto calibration = pointerCalibration();
+        const int pixels = calibration ? static_cast<int>(std::lround(calibration->pixelsFor(step))) : step;
+        if (progress) {
+            progress(0, static_cast<size_t>(reports));
+        }
+        for (int i = 1; i <= reports; ++i) {
+            sendMouseReport(makeMouseReport(buttonState_, static_cast<int8_t>(step), 0));
+            pacer_.advance(mouseMoveDelay());
+            lastPointerX_ += pixels;
+            if (progress) {
+                progress(static_cast<size_t>(i), static_cast<size_t>(reports));
+            }
+            reportBoundary();
+        }
+        return step * reports;
+    }
+
+    void setPointerCalibration(std::shared_ptr<const HIDPointerCalibration> calibration)
+    {
+        const std::lock_guard<std::mutex> lock(calibrationMutex_);
+        calibration_ = std::move(calibration);
+    }
+
+    std::shared_ptr<const HIDPointerCalibration> pointerCalibration() const
+    {
+        const std::lock_guard<std::mutex> lock(calibrationMutex_);
+        return calibration_;
+    }
+
+    void releaseAll()
+    {
+        const auto lock = lockExecution();
+        if (config_.keyboard.enabled) {
+            sendKeyboardReport(makeKeyboardReleaseReport());
+        }
+        if (config_.mouse.enabled) {
+            buttonState_ = 0;
+            if (config_.mouse.absolute) {
+                sendAbsolutePointerReport(0);
+            } else {
+                sendMouseReport(makeMouseReport(0, 0, 0));
+            }
+        }
+    }
+
+    void setReportBoundaryHook(std::function<void()> hook)
+    {
+        reportBoundaryHook_ = std::move(hook);
+    }
+
+    void setButton(MouseButton button, bool pressed, HIDDeadline deadline)
+    {
+        requireMouse();
+        const auto lock = lockExecution(deadline);
+        sendMouseButton(button, pressed);
+    }
+
+    void scroll(int delta, HIDDeadline deadline)
+    {
+        requireMouse();
+        const auto lock = lockExecution(deadline);
+        scrollInternal(delta);
+    }
+
+    HIDPointerState pointerState() const noexcept
+    {
+        return {lastPointerX_.load(std::memory_order_relaxed), lastPointerY_.load(std::memory_order_relaxed), buttonState_.load(std::memory_order_relaxed)};
+    }
+
+    HIDPacingState pacingState() const noexcept
+    {
+        HIDPacingState state;
+        state.adaptive = config_.safety.adaptivePacing;
+        state.connectionInterval = connectionMonitor_.interval().value_or(std::chrono::microseconds(0));
+        state.keypressInterval = keypressDelay();
+        state.pointerInterval = mouseMoveDelay();
+        return state;
+    }
+
+    // Mirrors the pacing of the execution paths below, starting from the
+    // current pointer position; queued work ahead may move it first, so this
+    // is an estimate for admission control rather than a promise.
+    std::chrono::microseconds estimateDuration(const std::vector<HIDAction>& actions) const
+    {
+        using std::chrono::milliseconds;
+        const auto keypress = keypressDelay();
+        const auto moveDelay = mouseMoveDelay();
+
+        int x = lastPointerX_.load(std::memory_order_relaxed);
+        int y = lastPointerY_.load(std::memory_order_relaxed);
+        const auto calibration = pointerCalibration();
+        std::chrono::microseconds total{0};
+        for (const auto& action : actions) {
+            switch (action.type) {
+            case HIDActionType::Click:
+            case HIDActionType::Move: {
+                if (config_.mouse.absolute) {
+                    total += moveDelay;
+                } else {
+                    total += moveDelay * static_cast<int64_t>(trajectoryLength(config_.safety.pointerProfile, action.x - x, action.y - y, config_.safety.mouseStepLimit, calibration.get()));
+                }
+                if (action.type == HIDActionType::Click) {
+                    total += moveDelay;
+                }
+                x = action.x;
+                y = action.y;
+                break;
+            }
+            case HIDActionType::Text:
+                total += keypress * static_cast<int64_t>(countTextReports(action.text));
+                break;
+            case HIDActionType::Wait:
+                total += milliseconds(action.waitMs);
+                break;
+            }
+        }
+        return total;
+    }
+
+    std::vector<HIDActionTiming> executeBatch(const std::vector<HIDAction>& actions, const HIDProgressCallback& progress)
+    {
+        for (const auto& action : actions) {
+            if (action.type == HIDActionType::Text) {
+                requireKeyboard();
+            } else if (action.type == HIDActionType::Click || action.type == HIDActionType::Move) {
+                requireMouse();
+            }
+        }
+
+        std::vector<HIDActionTiming> timings;
+        timings.reserve(actions.size());
+
+        const auto lock = lockExecution();
+        if (progress) {
+            progress(0, actions.size());
+        }
+        const auto batchStart = std::chrono::steady_clock::now();
+        for (const auto& action : actions) {
+            const auto stepStart = std::chrono::steady_clock::now();
+            switch (action.type) {
+            case HIDActionType::Click:
+                clickInternal(action.x, action.y, action.button, {});
+                break;
+            case HIDActionType::Move:
+                movePointerInternal(action.x, action.y, {});
+                break;
+            case HIDActionType::Text:
+                sendTextInternal(action.text, {});
+                break;
+            case HIDActionType::Wait:
+                waitInternal(action.waitMs);
+                break;
+            }
+            const auto stepEnd = std::chrono::steady_clock::now();
+            timings.push_back({std::chrono::duration_cast<std::chrono::microseconds>(stepStart - batchStart),
+                               std::chrono::duration_cast<std::chrono::microseconds>(stepEnd - stepStart)});
+            if (progress) {
+                progress(timings.size(), actions.size());
+            }
+        }
+        return timings;
+    }
+
+private:
+    // Holds the execution lock and, on the way out, waits until every report
+    // queued under it has been emitted, so an action returns only once its
+    // input has reached the host stack.
+    class ExecutionScope {
+    public:
+        ExecutionScope(Impl& impl, std::unique_lock<std::recursive_mutex> lock)
+            : impl_(impl)
+            , lock_(std::move(lock))
+        {
+        }
+
+        ~ExecutionScope()
+        {
+            try {
+                impl_.settle();
+            } catch (const HIDReportRingClosed&) {
+                // stop() is draining the ring; nothing left to wait for.
+            }
+        }
+
+        ExecutionScope(const ExecutionScope&) = delete;
+        ExecutionScope& operator=(const ExecutionScope&) = delete;
+
+    private:
+        Impl& impl_;
+        std::unique_lock<std::recursive_mutex> lock_;
+    };
+
+    ExecutionScope lockExecution(HIDDeadline deadline = {})
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::recursive_mutex> lock(executionMutex_);
+        if (!ring_) {
+            throw std::runtime_error("HID server is not running");
+        }
+        const auto acquired = std::chrono::steady_clock::now();
+        hidMetrics().executionWait.observe(acquired - start);
+        if (deadline && acquired > *deadline) {
+            throw HIDDeadlineExpired();
+        }
+        pacer_.restart();
+        return ExecutionScope{*this, std::move(lock)};
+    }
+
+    // Producers only format reports and stamp them with the pacer's due time;
+    // the output thread owns the sleeping and the D-Bus emission.
+    void enqueueReport(HIDReportChannel channel, const uint8_t* data, size_t size)
+    {
+        HIDReportRecord record;
+        record.channel = channel;
+        record.size = static_cast<uint8_t>(size);
+        std::copy(data, data + size, record.bytes.begin());
+        record.due = pacer_.due();
+        lastTicket_ = ring_->push(record);
+    }
+
+    // Throws HIDReportRingClosed once stop() has closed the ring.
+    void settle() const
+    {
+        ring_->awaitRetired(lastTicket_);
+    }
+
+    void runOutput()
+    {
+        HIDReportRecord record;
+        while (ring_->pop(record)) {
+            auto now = HIDPacer::now();
+            if (record.due > now) {
+                now = HIDPacer::sleepUntil(record.due);
+            }
+            hidMetrics().pacingSlip.observe(now - record.due);
+            try {
+                emitReport(record);
+            } catch (const std::exception& ex) {
+                std::cerr << "[hid] Report notification failed: " << ex.what() << std::endl;
+            }
+            ring_->retire();
+        }
+    }
+
+    // Records carry report-protocol reports. Each goes out once, on the
+    // characteristic for the protocol mode the host selected, or on the other
+    // one if only that has notifications enabled. Boot reports are the report
+    // without its ID, and for the mouse without the wheel; the absolute
+    // pointer has no boot format and is dropped in boot mode.
+    void emitReport(const HIDReportRecord& record)
+    {
+        auto& routes = hidMetrics().routes;
+        const bool bootMode = protocolModeValue_.load(std::memory_order_relaxed) == kProtocolBootMode;
+        if (record.channel == HIDReportChannel::AbsolutePointer) {
+            if (bootMode) {
+                routes.dropped.add();
+                return;
+            }
+            notifyReport(*absolutePointerInput_, record.bytes.data(), record.size, routes.report);
+            return;
+        }
+
+        const bool keyboard = record.channel == HIDReportChannel::Keyboard;
+        auto& reportInput = keyboard ? *keyboardInput_ : *mouseInput_;
+        auto& bootInput = keyboard ? *bootKeyboardInput_ : *bootMouseInput_;
+        bool boot = bootMode;
+        if (!(boot ? bootInput : reportInput).notifying() && (boot ? reportInput : bootInput).notifying()) {
+            boot = !boot;
+        }
+        if (boot) {
+            notifyReport(bootInput, record.bytes.data() + 1, keyboard ? record.size - 1 : 3, routes.boot);
+        } else {
+            notifyReport(reportInput, record.bytes.data(), record.size, routes.report);
+        }
+    }
+
+    static void notifyReport(GattCharacteristic& characteristic, const uint8_t* data, size_t size, MetricCounter& route)
+    {
+        (characteristic.notifying() ? route : hidMetrics().routes.unsubscribed).add();
+        characteristic.notifyValue(data, size);
+    }
+
+    std::chrono::microseconds keypressDelay() const noexcept
+    {
+        if (const auto interval = adaptiveInterval()) {
+            return *interval;
+        }
+        return std::chrono::microseconds(config_.safety.keypressDelayUs);
+    }
+
+    std::chrono::microseconds mouseMoveDelay() const noexcept
+    {
+        if (const auto interval = adaptiveInterval()) {
+            return *interval;
+        }
+        return std::chrono::microseconds(config_.safety.mouseMoveDelayUs);
+    }
+
+    // One report per connection event is the most the link delivers; pacing
+    // any faster only queues reports in the controller.
+    std::optional<std::chrono::microseconds> adaptiveInterval() const noexcept
+    {
+        if (!config_.safety.adaptivePacing) {
+            return std::nullopt;
+        }
+        const auto interval = connectionMonitor_.interval();
+        if (!interval) {
+            return std::nullopt;
+        }
+        return std::max(*interval, std::chrono::microseconds(config_.safety.minReportIntervalUs));
+    }
+
+    void requireKeyboard() const
     {
         if (!config_.keyboard.enabled) {
             throw std::runtime_error("Keyboard input is disabled in configuration");
         }
-        std::lock_guard<std::mutex> lock(executionMutex_);
-        for (char ch : text) {
-            if (ch == '\r') {
+    }
+
+    void requireMouse() const
+    {
+        if (!config_.mouse.enabled) {
+            throw std::runtime_error("Mouse input is disabled in configuration");
+        }
+    }
+
+    // Replays the cached report sequence, which assumes all keys start up.
+    // If a boundary finds the keyboard state changed under it (an interrupt
+    // released the held key), the rest is typed live from there.
+    void sendTextInternal(const std::string& text, const HIDProgressCallback& progress)
+    {
+        if (progress) {
+            progress(0, text.size());
+        }
+        const auto compiled = textCache_.get(text);
+        hidMetrics().unsupportedCharacters.add(compiled->unsupported);
+        if (keyboardState_ != makeKeyboardReleaseReport()) {
+            typeLive(text, 0, progress);
+            return;
+        }
+
+        size_t next = 0;
+        for (const auto& step : compiled->steps) {
+            for (; next < step.reportsEnd; ++next) {
+                sendKeyboardReport(compiled->reports[next]);
+                pacer_.advance(keypressDelay());
+            }
+            if (progress) {
+                progress(step.done, text.size());
+            }
+            reportBoundary();
+            if (keyboardState_ != compiled->reports[next - 1]) {
+                typeLive(text, step.done, progress);
+                return;
+            }
+        }
+        for (; next < compiled->reports.size(); ++next) {
+            sendKeyboardReport(compiled->reports[next]);
+            pacer_.advance(keypressDelay());
+        }
+    }
+
+    void typeLive(const std::string& text, size_t from, const HIDProgressCallback& progress)
+    {
+        HIDTypingEncoder encoder;
+        encoder.resync(keyboardState_);
+        for (size_t done = from; done < text.size();) {
+            const char32_t codePoint = decodeUtf8(text, done);
+            if (codePoint == U'\r') {
                 continue; // treat CR as newline handled by '\n'
             }
-            auto stroke = lookupKeyboardStroke(ch);
-            if (!stroke) {
-                std::cerr << "[hid] Unsupported character: '" << ch << "'" << std::endl;
+            const auto key = lookupKeyboardKey(config_.keyboard.layout, codePoint);
+            if (!key.mapped()) {
                 continue;
             }
-            auto report = makeKeyboardReport(stroke->modifiers, stroke->usage);
-            keyboardInput_->notifyValue(toVector(report));
-            bootKeyboardInput_->notifyValue(std::vector<uint8_t>(report.begin() + 1, report.end()));
-            std::this_thread::sleep_for(std::chrono::milliseconds(config_.safety.keypressDelayMs));
-            keyboardInput_->notifyValue(toVector(makeKeyboardReleaseReport()));
-            bootKeyboardInput_->notifyValue(std::vector<uint8_t>(makeKeyboardReleaseReport().begin() + 1,
-                                                                 makeKeyboardReleaseReport().end()));
-            std::this_thread::sleep_for(std::chrono::milliseconds(config_.safety.keypressDelayMs));
+            const auto reports = encoder.type(key);
+            for (size_t i = 0; i < reports.count; ++i) {
+                sendKeyboardReport(reports.data[i]);
+                pacer_.advance(keypressDelay());
+            }
+            if (progress) {
+                progress(done, text.size());
+            }
+            // A preempting job or the interrupt hook may have released keys.
+            reportBoundary();
+            encoder.resync(keyboardState_);
+        }
+        if (const auto release = encoder.finish()) {
+            sendKeyboardReport(*release);
+            pacer_.advance(keypressDelay());
         }
     }
 
-    void movePointer(int x, int y)
+    // Reports sendTextInternal() would emit for text starting from all keys
+    // up. Compiling here also warms the cache for the execution that follows.
+    size_t countTextReports(const std::string& text) const
     {
-        if (!config_.mouse.enabled) {
-            throw std::runtime_error("Mouse input is disabled in configuration");
-        }
-        std::lock_guard<std::mutex> lock(executionMutex_);
-        movePointerInternal(x, y);
+        return textCache_.get(text, false)->reports.size();
     }
 
-    void click(int x, int y, MouseButton button)
+    void tapKeyInternal(uint8_t modifiers, uint8_t usage)
     {
-        if (!config_.mouse.enabled) {
-            throw std::runtime_error("Mouse input is disabled in configuration");
+        sendKeyboardReport(makeKeyboardReport(modifiers, usage));
+        pacer_.advance(keypressDelay());
+        sendKeyboardReport(makeKeyboardReleaseReport());
+        pacer_.advance(keypressDelay());
+    }
+
+    void sendKeyboardReport(const std::array<uint8_t, 9>& report)
+    {
+        keyboardState_ = report;
+        enqueueReport(HIDReportChannel::Keyboard, report.data(), report.size());
+    }
+
+    void sendMouseReport(const std::array<uint8_t, 5>& report)
+    {
+        enqueueReport(HIDReportChannel::Mouse, report.data(), report.size());
+    }
+
+    void clickInternal(int x, int y, MouseButton button, const HIDProgressCallback& progress)
+    {
+        if (config_.mouse.absolute) {
+            // The press carries the position, so a click is two reports
+            // however far the pointer travels.
+            if (progress) {
+                progress(0, 2);
+            }
+            setPointerPosition(x, y);
+            sendMouseButton(button, true);
+            pacer_.advance(mouseMoveDelay());
+            if (progress) {
+                progress(1, 2);
+            }
+            sendMouseButton(button, false);
+            if (progress) {
+                progress(2, 2);
+            }
+            reportBoundary();
+            return;
+        }
+        size_t moveTotal = 0;
+        HIDProgressCallback moveProgress;
+        if (progress) {
+            moveProgress = [&](size_t done, size_t total) {
+                moveTotal = total;
+                progress(done, total + 1);
+            };
         }
-        std::lock_guard<std::mutex> lock(executionMutex_);
-        movePointerInternal(x, y);
+        movePointerInternal(x, y, moveProgress);
         sendMouseButton(button, true);
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.safety.mouseMoveDelayMs));
+        pacer_.advance(mouseMoveDelay());
         sendMouseButton(button, false);
+        if (progress) {
+            progress(moveTotal + 1, moveTotal + 1);
+        }
+        reportBoundary();
     }
 
-private:
     void setupApplication()
     {
         appRoot_ = sdbus::createObject(*connection_, std::string{kAppRoot});
@@ -631,6 +1213,7 @@ private:
                                                              [this](const std::vector<uint8_t>& value, const std::map<std::string, sdbus::Variant>&) {
                                                                  if (!value.empty()) {
                                                                      protocolModeValue_ = value[0];
+                                                                     protocolMode_->setInitialValue({value[0]});
                                                                  }
                                                              },
                                                              nullptr);
@@ -639,6 +1222,7 @@ private:
 
         keyboardInput_ = std::make_shared<GattCharacteristic>(*connection_, std::string{kKeyboardInputReportPath}, std::string{kReportUuid}, std::string{kServicePath}, std::vector<std::string>{"read", "notify"}, nullptr, nullptr, nullptr);
         keyboardInput_->setInitialValue(toVector(makeKeyboardReleaseReport()));
+        keyboardInput_->setReportChannel(HIDReportChannel::Keyboard);
         managedObjects_.push_back(keyboardInput_);
 
         auto keyboardReportRef = std::make_shared<GattDescriptor>(*connection_, std::string{kKeyboardInputReportRefPath}, std::string{kReportReferenceUuid}, std::string{kKeyboardInputReportPath}, std::vector<std::string>{"read"}, std::vector<uint8_t>{0x01, 0x01});
@@ -647,6 +1231,7 @@ private:
 
         mouseInput_ = std::make_shared<GattCharacteristic>(*connection_, std::string{kMouseInputReportPath}, std::string{kReportUuid}, std::string{kServicePath}, std::vector<std::string>{"read", "notify"}, nullptr, nullptr, nullptr);
         mouseInput_->setInitialValue(toVector(makeMouseReport(0x00, 0x00, 0x00)));
+        mouseInput_->setReportChannel(HIDReportChannel::Mouse);
         managedObjects_.push_back(mouseInput_);
 
         auto mouseReportRef = std::make_shared<GattDescriptor>(*connection_, std::string{kMouseInputReportRefPath}, std::string{kReportReferenceUuid}, std::string{kMouseInputReportPath}, std::vector<std::string>{"read"}, std::vector<uint8_t>{0x02, 0x01});
@@ -655,12 +1240,23 @@ private:
 
         bootKeyboardInput_ = std::make_shared<GattCharacteristic>(*connection_, std::string{kBootKeyboardInputPath}, std::string{kBootKeyboardInputUuid}, std::string{kServicePath}, std::vector<std::string>{"read", "notify"}, nullptr, nullptr, nullptr);
         bootKeyboardInput_->setInitialValue(std::vector<uint8_t>(makeKeyboardReleaseReport().begin() + 1, makeKeyboardReleaseReport().end()));
+        bootKeyboardInput_->setReportChannel(HIDReportChannel::BootKeyboard);
         managedObjects_.push_back(bootKeyboardInput_);
 
         bootMouseInput_ = std::make_shared<GattCharacteristic>(*connection_, std::string{kBootMouseInputPath}, std::string{kBootMouseInputUuid}, std::string{kServicePath}, std::vector<std::string>{"read", "notify"}, nullptr, nullptr, nullptr);
         bootMouseInput_->setInitialValue({0x00, 0x00, 0x00});
+        bootMouseInput_->setReportChannel(HIDReportChannel::BootMouse);
         managedObjects_.push_back(bootMouseInput_);
 
+        absolutePointerInput_ = std::make_shared<GattCharacteristic>(*connection_, std::string{kAbsolutePointerInputPath}, std::string{kReportUuid}, std::string{kServicePath}, std::vector<std::string>{"read", "notify"}, nullptr, nullptr, nullptr);
+        absolutePointerInput_->setInitialValue(toVector(makeAbsolutePointerReport(0x00, 0, 0)));
+        absolutePointerInput_->setReportChannel(HIDReportChannel::AbsolutePointer);
+        managedObjects_.push_back(absolutePointerInput_);
+
+        auto absolutePointerReportRef = std::make_shared<GattDescriptor>(*connection_, std::string{kAbsolutePointerInputRefPath}, std::string{kReportReferenceUuid}, std::string{kAbsolutePointerInputPath}, std::vector<std::string>{"read"}, std::vector<uint8_t>{0x03, 0x01});
+        absolutePointerInput_->addDescriptor(absolutePointerReportRef);
+        managedObjects_.push_back(absolutePointerReportRef);
+
         auto deviceInfoService = std::make_shared<GattService>(*connection_, std::string{kDeviceInfoServicePath}, std::string{kDeviceInfoServiceUuid}, true);
         managedObjects_.push_back(deviceInfoService);
 
@@ -736,32 +1332,164 @@ private:
         }
     }
 
-    void movePointerInternal(int targetX, int targetY)
+    // The remaining distance is re-read every step because a preempting job
+    // may move the pointer at a report boundary. With followLatest the
+    // target is re-read too, so a newer published target replaces the rest
+    // of the path at the next step.
+    // The whole path is planned up front and replanned from the current
+    // position only if the target changes or a preempting job moved the
+    // pointer in between.
+    void movePointerInternal(int targetX, int targetY, const HIDProgressCallback& progress, bool followLatest = false)
+    {
+        if (config_.mouse.absolute) {
+            moveAbsoluteInternal(targetX, targetY, progress, followLatest);
+            return;
+        }
+
+        uint64_t generation = 0;
+        if (followLatest) {
+            const std::lock_guard<std::mutex> lock(targetMutex_);
+            generation = pointerTarget_.generation;
+        }
+
+        const auto calibration = pointerCalibration();
+        std::vector<HIDPointerStep> plan;
+        size_t next = 0;
+        size_t steps = 0;
+        int expectedX = lastPointerX_;
+        int expectedY = lastPointerY_;
+        const auto replan = [&]() {
+            expectedX = lastPointerX_;
+            expectedY = lastPointerY_;
+            planTrajectory(config_.safety.pointerProfile, targetX - expectedX, targetY - expectedY, config_.safety.mouseStepLimit, plan, calibration.get());
+            next = 0;
+        };
+        replan();
+        if (progress) {
+            progress(0, plan.size());
+        }
+
+        while (true) {
+            bool retargeted = false;
+            if (followLatest) {
+                const std::lock_guard<std::mutex> lock(targetMutex_);
+                if (pointerTarget_.generation != generation) {
+                    generation = pointerTarget_.generation;
+                    targetX = pointerTarget_.x;
+                    targetY = pointerTarget_.y;
+                    retargeted = true;
+                    hidMetrics().pointerRetargets.add();
+                }
+            }
+            if (retargeted || lastPointerX_ != expectedX || lastPointerY_ != expectedY) {
+                replan();
+            }
+            if (next == plan.size()) {
+                break;
+            }
+            const auto step = plan[next++];
+            sendMouseReport(makeMouseReport(buttonState_, step.dx, step.dy));
+            pacer_.advance(mouseMoveDelay());
+            lastPointerX_ += step.pixelsX;
+            lastPointerY_ += step.pixelsY;
+            expectedX += step.pixelsX;
+            expectedY += step.pixelsY;
+            ++steps;
+            if (progress) {
+                progress(steps, steps + plan.size() - next);
+            }
+            reportBoundary();
+        }
+    }
+
+    // One report at the target; a newer latest-wins target simply replaces it.
+    void moveAbsoluteInternal(int targetX, int targetY, const HIDProgressCallback& progress, bool followLatest)
     {
-        const int maxStep = std::min<int>(config_.safety.mouseStepLimit, 127);
-        int dx = targetX - lastPointerX_;
-        int dy = targetY - lastPointerY_;
+        if (followLatest) {
+            const std::lock_guard<std::mutex> lock(targetMutex_);
+            targetX = pointerTarget_.x;
+            targetY = pointerTarget_.y;
+        }
+        if (progress) {
+            progress(0, 1);
+        }
+        setPointerPosition(targetX, targetY);
+        sendAbsolutePointerReport(buttonState_);
+        pacer_.advance(mouseMoveDelay());
+        if (progress) {
+            progress(1, 1);
+        }
+        reportBoundary();
+    }
+
+    void setPointerPosition(int x, int y)
+    {
+        lastPointerX_ = std::clamp<int>(x, 0, static_cast<int>(config_.mouse.screenWidth) - 1);
+        lastPointerY_ = std::clamp<int>(y, 0, static_cast<int>(config_.mouse.screenHeight) - 1);
+    }
 
-        while (dx != 0 || dy != 0) {
-            int stepX = std::clamp(dx, -maxStep, maxStep);
-            int stepY = std::clamp(dy, -maxStep, maxStep);
-            auto report = makeMouseReport(0x00, static_cast<int8_t>(stepX), static_cast<int8_t>(stepY));
-            mouseInput_->notifyValue(toVector(report));
-            bootMouseInput_->notifyValue({static_cast<uint8_t>(report[1]), static_cast<uint8_t>(report[2]), static_cast<uint8_t>(report[3])});
-            std::this_thread::sleep_for(std::chrono::milliseconds(config_.safety.mouseMoveDelayMs));
-            lastPointerX_ += stepX;
-            lastPointerY_ += stepY;
-            dx -= stepX;
-            dy -= stepY;
+    static uint16_t scaleAbsolute(int pixel, uint32_t extent)
+    {
+        if (extent <= 1) {
+            return 0;
         }
+        return static_cast<uint16_t>((static_cast<uint64_t>(pixel) * kAbsolutePointerMax + (extent - 1) / 2) / (extent - 1));
+    }
+
+    void sendAbsolutePointerReport(uint8_t buttons)
+    {
+        const auto report = makeAbsolutePointerReport(buttons, scaleAbsolute(lastPointerX_, config_.mouse.screenWidth),
+                                                       scaleAbsolute(lastPointerY_, config_.mouse.screenHeight));
+        enqueueReport(HIDReportChannel::AbsolutePointer, report.data(), report.size());
     }
 
     void sendMouseButton(MouseButton button, bool pressed)
     {
-        uint8_t mask = pressed ? mouseButtonMask(button) : 0x00;
-        auto report = makeMouseReport(mask, 0, 0);
-        mouseInput_->notifyValue(toVector(report));
-        bootMouseInput_->notifyValue({mask, 0x00, 0x00});
+        const uint8_t mask = pressed ? (buttonState_ | mouseButtonMask(button)) : (buttonState_ & ~mouseButtonMask(button));
+        buttonState_ = mask;
+        if (config_.mouse.absolute) {
+            sendAbsolutePointerReport(mask);
+            return;
+        }
+        sendMouseReport(makeMouseReport(mask, 0, 0));
+    }
+
+    void scrollInternal(int delta)
+    {
+        while (delta != 0) {
+            const int step = std::clamp(delta, -127, 127);
+            const auto report = makeMouseReport(buttonState_, 0, 0, static_cast<int8_t>(step));
+            enqueueReport(HIDReportChannel::Mouse, report.data(), report.size());
+            delta -= step;
+            if (delta != 0) {
+                pacer_.advance(mouseMoveDelay());
+                reportBoundary();
+            }
+        }
+    }
+
+    // Waits are sliced so that cancellation and preemption stay as prompt
+    // during a batch wait as between reports.
+    void waitInternal(uint32_t waitMs)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+        while (true) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
+            }
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now, kWaitSlice));
+            reportBoundary();
+        }
+        pacer_.restart();
+    }
+
+    void reportBoundary()
+    {
+        settle();
+        if (reportBoundaryHook_) {
+            reportBoundaryHook_();
+        }
     }
 
     HIDConfig config_;
@@ -782,21 +1510,52 @@ private:
     std::shared_ptr<GattCharacteristic> mouseInput_;
     std::shared_ptr<GattCharacteristic> bootKeyboardInput_;
     std::shared_ptr<GattCharacteristic> bootMouseInput_;
+    std::shared_ptr<GattCharacteristic> absolutePointerInput_;
     std::shared_ptr<GattCharacteristic> manufacturer_;
     std::shared_ptr<GattCharacteristic> pnpId_;
 
-    uint8_t protocolModeValue_{kProtocolReportMode};
+    // Written by BlueZ on the D-Bus thread, read by the output thread.
+    std::atomic<uint8_t> protocolModeValue_{kProtocolReportMode};
     uint8_t controlPointValue_{0x00};
 
-    int lastPointerX_{0};
-    int lastPointerY_{0};
+    // Written only with executionMutex_ held; atomic so pointerState() can
+    // be read without waiting for an action in progress.
+    std::atomic<int> lastPointerX_{0};
+    std::atomic<int> lastPointerY_{0};
+    std::atomic<uint8_t> buttonState_{0};
+    // Last keyboard report sent; written only with executionMutex_ held.
+    std::array<uint8_t, 9> keyboardState_{makeKeyboardReleaseReport()};
+    mutable HIDTextCache textCache_{config_.keyboard.textCacheBytes, config_.keyboard.layout};
 
     std::thread eventThread_;
     std::atomic<bool> running_{false};
     mutable std::mutex stateMutex_;
-    std::mutex executionMutex_;
+    // Recursive because a preempting job runs nested inside the interrupted
+    // one, on the same thread, from a report boundary.
+    std::recursive_mutex executionMutex_;
+    std::function<void()> reportBoundaryHook_;
+    HIDPacer pacer_;
+    uint64_t lastTicket_{0};
+
+    mutable std::mutex calibrationMutex_;
+    std::shared_ptr<const HIDPointerCalibration> calibration_;
+
+    std::atomic<uint64_t> nextTargetGeneration_{0};
+    std::mutex targetMutex_;
+    HIDPointerTarget pointerTarget_;
+
+    // Created and destroyed with executionMutex_ held; the output thread uses
+    // it only between those points.
+    std::unique_ptr<HIDReportRing> ring_;
+    std::thread outputThread_;
+    HIDConnectionMonitor connectionMonitor_;
 };
 
+HIDDeadlineExpired::HIDDeadlineExpired()
+    : std::runtime_error("Action could not start before its deadline")
+{
+}
+
 BluetoothHIDServer::BluetoothHIDServer(HIDConfig config)
     : impl_(std::make_unique<Impl>(std::move(config)))
 {
@@ -814,19 +1573,104 @@ void BluetoothHIDServer::stop()
     impl_->stop();
 }
 
-void BluetoothHIDServer::sendText(const std::string& text)
+void BluetoothHIDServer::sendText(const std::string& text, const HIDProgressCallback& progress)
+{
+    impl_->sendText(text, progress);
+}
+
+void BluetoothHIDServer::click(int x, int y, MouseButton button, const HIDProgressCallback& progress)
+{
+    impl_->click(x, y, button, progress);
+}
+
+void BluetoothHIDServer::movePointer(int x, int y, const HIDProgressCallback& progress, HIDDeadline deadline)
+{
+    impl_->movePointer(x, y, progress, deadline);
+}
+
+std::vector<HIDActionTiming> BluetoothHIDServer::executeBatch(const std::vector<HIDAction>& actions, const HIDProgressCallback& progress)
+{
+    return impl_->executeBatch(actions, progress);
+}
+
+HIDPointerTarget BluetoothHIDServer::reservePointerTarget(int x, int y) noexcept
+{
+    return impl_->reservePointerTarget(x, y);
+}
+
+void BluetoothHIDServer::retargetPointer(const HIDPointerTarget& target)
+{
+    impl_->retargetPointer(target);
+}
+
+void BluetoothHIDServer::movePointer(const HIDPointerTarget& target, const HIDProgressCallback& progress)
+{
+    impl_->movePointer(target, progress);
+}
+
+void BluetoothHIDServer::moveRelative(int dx, int dy, HIDDeadline deadline)
+{
+    impl_->moveRelative(dx, dy, deadline);
+}
+
+void BluetoothHIDServer::tapKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline)
+{
+    impl_->tapKey(modifiers, usage, deadline);
+}
+
+void BluetoothHIDServer::setKey(uint8_t modifiers, uint8_t usage, HIDDeadline deadline)
+{
+    impl_->setKey(modifiers, usage, deadline);
+}
+
+void BluetoothHIDServer::setButton(MouseButton button, bool pressed, HIDDeadline deadline)
+{
+    impl_->setButton(button, pressed, deadline);
+}
+
+void BluetoothHIDServer::releaseAll()
+{
+    impl_->releaseAll();
+}
+
+int BluetoothHIDServer::probePointer(int step, int reports, const HIDProgressCallback& progress)
+{
+    return impl_->probePointer(step, reports, progress);
+}
+
+void BluetoothHIDServer::setReportBoundaryHook(std::function<void()> hook)
+{
+    impl_->setReportBoundaryHook(std::move(hook));
+}
+
+void BluetoothHIDServer::scroll(int delta, HIDDeadline deadline)
+{
+    impl_->scroll(delta, deadline);
+}
+
+std::chrono::microseconds BluetoothHIDServer::estimateDuration(const std::vector<HIDAction>& actions) const
+{
+    return impl_->estimateDuration(actions);
+}
+
+HIDPointerState BluetoothHIDServer::pointerState() const noexcept
+{
+    return impl_->pointerState();
+}
+
+HIDPacingState BluetoothHIDServer::pacingState() const noexcept
 {
-    impl_->sendText(text);
+    return impl_->pacingState();
 }
 
-void BluetoothHIDServer::click(int x, int y, MouseButton button)
+void BluetoothHIDServer::setPointerCalibration(std::shared_ptr<const HIDPointerCalibration> calibration)
 {
-    impl_->click(x, y, button);
+    impl_->setPointerCalibration(std::move(calibration));
 }
 
-void BluetoothHIDServer::movePointer(int x, int y)
+std::shared_ptr<const HIDPointerCalibration> BluetoothHIDServer::pointerCalibration() const
 {
-    impl_->movePointer(x, y);
+    return impl_->pointerCalibration();
 }
 
 bool BluetoothHIDServer::isRunning() const noexcept
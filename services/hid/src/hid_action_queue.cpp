@@ -0,0 +1,460 @@
+#include "hid_action_queue.hpp"
+
+#include "hid_metrics.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+// Set on the executor thread so checkpoint() can ignore calls made by other
+// threads driving the HID server directly.
+thread_local const HIDActionQueue* tExecutingQueue = nullptr;
+
+size_t laneIndex(HIDPriority priority)
+{
+    return static_cast<size_t>(priority);
+}
+
+} // namespace
+
+std::string_view jobStateName(HIDJobState state)
+{
+    switch (state) {
+    case HIDJobState::Queued:
+        return "queued";
+    case HIDJobState::Running:
+        return "running";
+    case HIDJobState::Succeeded:
+        return "succeeded";
+    case HIDJobState::Failed:
+        return "failed";
+    case HIDJobState::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+std::string_view priorityName(HIDPriority priority)
+{
+    switch (priority) {
+    case HIDPriority::Low:
+        return "low";
+    case HIDPriority::Normal:
+        return "normal";
+    case HIDPriority::High:
+        return "high";
+    }
+    return "normal";
+}
+
+HIDPriority priorityFromString(std::string_view name)
+{
+    if (name == "low") {
+        return HIDPriority::Low;
+    }
+    if (name == "normal") {
+        return HIDPriority::Normal;
+    }
+    if (name == "high") {
+        return HIDPriority::High;
+    }
+    throw std::invalid_argument("priority must be one of low, normal, high");
+}
+
+HIDJobCancelled::HIDJobCancelled()
+    : std::runtime_error("Job cancelled")
+{
+}
+
+HIDQueueFullError::HIDQueueFullError(const std::string& message, std::chrono::milliseconds retryAfter)
+    : std::runtime_error(message)
+    , retryAfter_(retryAfter)
+{
+}
+
+HIDActionQueue::HIDActionQueue(const HIDJobsConfig& config)
+    : retainFinished_(config.retainFinished)
+    , maxDepth_(config.maxQueueDepth)
+    , maxDelay_(std::chrono::milliseconds(config.maxQueueDelayMs))
+{
+}
+
+HIDActionQueue::~HIDActionQueue()
+{
+    stop();
+}
+
+void HIDActionQueue::setObserver(Observer observer, const std::atomic<size_t>* listeners)
+{
+    observer_ = std::move(observer);
+    listeners_ = listeners;
+}
+
+void HIDActionQueue::setInterruptHook(InterruptHook hook)
+{
+    interruptHook_ = std::move(hook);
+}
+
+void HIDActionQueue::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    worker_ = std::thread([this]() { run(); });
+}
+
+void HIDActionQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+uint64_t HIDActionQueue::submit(std::string kind, HIDPriority priority, std::chrono::microseconds cost, Task task, Completion completion)
+{
+    auto job = std::make_shared<Job>();
+    job->kind = std::move(kind);
+    job->priority = priority;
+    job->task = std::move(task);
+    job->cost = cost;
+    if (completion) {
+        job->watchers.push_back(std::move(completion));
+    }
+
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextJobId_++;
+        job->id = id;
+        enqueue(job);
+        jobs_.emplace(id, std::move(job));
+    }
+    cv_.notify_one();
+    return id;
+}
+
+void HIDActionQueue::post(std::chrono::microseconds cost, Task task, Completion completion)
+{
+    auto job = std::make_shared<Job>();
+    job->task = std::move(task);
+    job->cost = cost;
+    job->watchers.push_back(std::move(completion));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enqueue(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+std::optional<HIDJobSnapshot> HIDActionQueue::find(uint64_t id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return std::nullopt;
+    }
+    return snapshot(*it->second);
+}
+
+bool HIDActionQueue::watch(uint64_t id, Completion completion)
+{
+    HIDJobSnapshot finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = jobs_.find(id);
+        if (it == jobs_.end()) {
+            return false;
+        }
+        auto& job = *it->second;
+        if (job.state < HIDJobState::Succeeded) {
+            job.watchers.push_back(std::move(completion));
+            return true;
+        }
+        finished = snapshot(job);
+    }
+    completion(finished);
+    return true;
+}
+
+bool HIDActionQueue::cancel(uint64_t id)
+{
+    std::shared_ptr<Job> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = jobs_.find(id);
+        if (it == jobs_.end()) {
+            return false;
+        }
+        const auto& job = it->second;
+        if (job->state == HIDJobState::Running) {
+            job->cancelRequested.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        if (job->state != HIDJobState::Queued) {
+            return false;
+        }
+        auto& lane = pending_[laneIndex(job->priority)];
+        lane.erase(std::find(lane.begin(), lane.end(), job));
+        pendingCost_[laneIndex(job->priority)] -= job->cost;
+        removed = job;
+    }
+    finish(removed, HIDJobState::Cancelled, {}, "Job cancelled");
+    return true;
+}
+
+void HIDActionQueue::checkpoint()
+{
+    if (tExecutingQueue != this) {
+        return;
+    }
+
+    std::shared_ptr<Job> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_.empty()) {
+            return;
+        }
+        current = active_.back();
+    }
+    if (current->cancelRequested.load(std::memory_order_relaxed)) {
+        if (interruptHook_) {
+            interruptHook_();
+        }
+        throw HIDJobCancelled();
+    }
+    if (current->priority == HIDPriority::High) {
+        return;
+    }
+
+    bool interrupted = false;
+    while (true) {
+        std::shared_ptr<Job> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            next = takeNextLocked(static_cast<HIDPriority>(laneIndex(current->priority) + 1));
+        }
+        if (!next) {
+            return;
+        }
+        if (!interrupted && interruptHook_) {
+            interruptHook_();
+        }
+        interrupted = true;
+        execute(next);
+    }
+}
+
+size_t HIDActionQueue::depth() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (const auto& lane : pending_) {
+        total += lane.size();
+    }
+    return total;
+}
+
+std::chrono::microseconds HIDActionQueue::backlog() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return backlogLocked(Clock::now(), HIDPriority::Low);
+}
+
+// Limits apply to the work that would run ahead of the new job: its own lane
+// and those above it, plus whatever is executing. A job is always admitted
+// when nothing is ahead of it, however long it is expected to run; otherwise
+// one oversized action could never be accepted.
+void HIDActionQueue::enqueue(std::shared_ptr<Job> job)
+{
+    size_t ahead = 0;
+    for (size_t lane = laneIndex(job->priority); lane < kHIDPriorityCount; ++lane) {
+        ahead += pending_[lane].size();
+    }
+    const auto waiting = backlogLocked(Clock::now(), job->priority);
+    const bool tooDeep = maxDepth_ != 0 && ahead >= maxDepth_;
+    const bool tooSlow = maxDelay_.count() != 0 && waiting.count() != 0 && waiting + job->cost > maxDelay_;
+    if (tooDeep || tooSlow) {
+        hidMetrics().queueRejections.add();
+        const auto retryAfter = std::chrono::ceil<std::chrono::milliseconds>(tooDeep ? waiting : waiting + job->cost - maxDelay_);
+        throw HIDQueueFullError(tooDeep ? "Action queue is full" : "Action queue would exceed its delay limit",
+                                std::max(retryAfter, std::chrono::milliseconds(1)));
+    }
+
+    job->submitted = Clock::now();
+    pendingCost_[laneIndex(job->priority)] += job->cost;
+    pending_[laneIndex(job->priority)].push_back(std::move(job));
+}
+
+std::chrono::microseconds HIDActionQueue::backlogLocked(Clock::time_point now, HIDPriority from) const
+{
+    std::chrono::microseconds total{0};
+    for (size_t lane = laneIndex(from); lane < kHIDPriorityCount; ++lane) {
+        total += pendingCost_[lane];
+    }
+    for (const auto& job : active_) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - job->started);
+        total += std::max(job->cost - elapsed, std::chrono::microseconds(0));
+    }
+    return total;
+}
+
+std::shared_ptr<HIDActionQueue::Job> HIDActionQueue::takeNextLocked(HIDPriority from)
+{
+    for (size_t lane = kHIDPriorityCount; lane-- > laneIndex(from);) {
+        if (!pending_[lane].empty()) {
+            auto job = std::move(pending_[lane].front());
+            pending_[lane].pop_front();
+            pendingCost_[lane] -= job->cost;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void HIDActionQueue::run()
+{
+    tExecutingQueue = this;
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() {
+                return !running_ || std::any_of(pending_.begin(), pending_.end(), [](const auto& lane) { return !lane.empty(); });
+            });
+            if (!running_) {
+                for (auto& lane : pending_) {
+                    lane.clear();
+                }
+                pendingCost_.fill(std::chrono::microseconds(0));
+                return;
+            }
+            job = takeNextLocked(HIDPriority::Low);
+        }
+        execute(job);
+    }
+}
+
+void HIDActionQueue::execute(const std::shared_ptr<Job>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->state = HIDJobState::Running;
+        job->started = Clock::now();
+        active_.push_back(job);
+    }
+
+    // The executor is the only writer of a running job, so it can take
+    // snapshots for the observer without the lock.
+    const bool observed = observer_ && job->id != 0;
+    const auto listening = [this]() {
+        return !listeners_ || listeners_->load(std::memory_order_relaxed) != 0;
+    };
+    if (observed && listening()) {
+        observer_(HIDJobEvent::Started, snapshot(*job));
+    }
+
+    const HIDProgressCallback progress = [this, &job, observed, &listening](size_t done, size_t total) {
+        job->progressTotal.store(total, std::memory_order_relaxed);
+        job->progressDone.store(done, std::memory_order_relaxed);
+        if (observed && listening()) {
+            observer_(HIDJobEvent::Progress, snapshot(*job));
+        }
+    };
+
+    try {
+        auto result = job->task(progress);
+        finish(job, HIDJobState::Succeeded, std::move(result), {});
+    } catch (const HIDJobCancelled& ex) {
+        finish(job, HIDJobState::Cancelled, {}, ex.what());
+    } catch (const std::exception& ex) {
+        if (job->id != 0) {
+            std::cerr << "[hid] Job " << job->id << " (" << job->kind << ") failed: " << ex.what() << std::endl;
+        }
+        finish(job, HIDJobState::Failed, {}, ex.what());
+    }
+}
+
+void HIDActionQueue::finish(const std::shared_ptr<Job>& job, HIDJobState state, std::string result, std::string error)
+{
+    std::vector<Completion> watchers;
+    HIDJobSnapshot finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->state = state;
+        job->finished = Clock::now();
+        job->result = std::move(result);
+        job->error = std::move(error);
+        job->task = nullptr;
+        if (!active_.empty() && active_.back() == job) {
+            active_.pop_back();
+        }
+        watchers.swap(job->watchers);
+        finished = snapshot(*job);
+
+        if (job->id != 0) {
+            finishedOrder_.push_back(job->id);
+        }
+        while (finishedOrder_.size() > retainFinished_) {
+            jobs_.erase(finishedOrder_.front());
+            finishedOrder_.pop_front();
+        }
+    }
+
+    if (observer_ && finished.id != 0) {
+        observer_(HIDJobEvent::Finished, finished);
+    }
+    for (auto& watcher : watchers) {
+        watcher(finished);
+    }
+}
+
+HIDJobSnapshot HIDActionQueue::snapshot(const Job& job) const
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    HIDJobSnapshot result;
+    result.id = job.id;
+    result.kind = job.kind;
+    result.priority = job.priority;
+    result.state = job.state;
+    result.progressDone = job.progressDone.load(std::memory_order_relaxed);
+    result.progressTotal = job.progressTotal.load(std::memory_order_relaxed);
+    result.result = job.result;
+    result.error = job.error;
+
+    const auto now = Clock::now();
+    switch (job.state) {
+    case HIDJobState::Queued:
+        result.queued = duration_cast<microseconds>(now - job.submitted);
+        break;
+    case HIDJobState::Running:
+        result.queued = duration_cast<microseconds>(job.started - job.submitted);
+        result.running = duration_cast<microseconds>(now - job.started);
+        break;
+    case HIDJobState::Succeeded:
+    case HIDJobState::Failed:
+    case HIDJobState::Cancelled:
+        if (job.started == Clock::time_point{}) {
+            result.queued = duration_cast<microseconds>(job.finished - job.submitted);
+            break;
+        }
+        result.queued = duration_cast<microseconds>(job.started - job.submitted);
+        result.running = duration_cast<microseconds>(job.finished - job.started);
+        break;
+    }
+    return result;
+}
@@ -0,0 +1,35 @@
+#include "hid_actions.hpp"
+
+#include <stdexcept>
+
+std::string_view actionTypeName(HIDActionType type)
+{
+    switch (type) {
+    case HIDActionType::Click:
+        return "click";
+    case HIDActionType::Move:
+        return "move";
+    case HIDActionType::Text:
+        return "text";
+    case HIDActionType::Wait:
+        return "wait";
+    }
+    return "unknown";
+}
+
+HIDActionType actionTypeFromString(std::string_view name)
+{
+    if (name == "click") {
+        return HIDActionType::Click;
+    }
+    if (name == "move") {
+        return HIDActionType::Move;
+    }
+    if (name == "text") {
+        return HIDActionType::Text;
+    }
+    if (name == "wait") {
+        return HIDActionType::Wait;
+    }
+    throw std::invalid_argument("Unsupported action type: " + std::string{name});
+}
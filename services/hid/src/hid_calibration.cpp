@@ -0,0 +1,131 @@
+#include "hid_calibration.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kMaxHostLength = 64;
+
+} // namespace
+
+bool isValidCalibrationHost(const std::string& host) noexcept
+{
+    if (host.empty() || host.size() > kMaxHostLength || host.front() == '.') {
+        return false;
+    }
+    return std::all_of(host.begin(), host.end(), [](char ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '.' || ch == '_' || ch == '-';
+    });
+}
+
+HIDPointerCalibration::HIDPointerCalibration(std::string host, std::vector<HIDGainSample> samples)
+    : host_(std::move(host))
+    , samples_(std::move(samples))
+{
+    if (!isValidCalibrationHost(host_)) {
+        throw std::invalid_argument("host must be 1-64 characters of [A-Za-z0-9._-]");
+    }
+    if (samples_.empty()) {
+        throw std::invalid_argument("calibration needs at least one sample");
+    }
+    for (const auto& sample : samples_) {
+        if (sample.step < 1 || sample.step > kMaxStep || sample.reports < 1 || sample.reports > kMaxProbeReports
+            || sample.pixels < 1 || sample.pixels > kMaxProbePixels) {
+            throw std::invalid_argument("samples need step 1-127, reports 1-1000 and a positive pixel distance");
+        }
+    }
+    std::sort(samples_.begin(), samples_.end(), [](const auto& a, const auto& b) { return a.step < b.step; });
+
+    // Piecewise linear through the origin and each sample, extended past the
+    // last sample with the last segment's slope.
+    std::vector<std::pair<int, double>> points{{0, 0.0}};
+    for (const auto& sample : samples_) {
+        const double perReport = static_cast<double>(sample.pixels) / sample.reports;
+        if (points.back().first == sample.step) {
+            throw std::invalid_argument("samples must have distinct step sizes");
+        }
+        if (perReport <= points.back().second) {
+            throw std::invalid_argument("pixels per report must grow with step size");
+        }
+        points.emplace_back(sample.step, perReport);
+    }
+    size_t segment = 1;
+    for (int counts = 0; counts <= kMaxStep; ++counts) {
+        while (segment + 1 < points.size() && counts > points[segment].first) {
+            ++segment;
+        }
+        const auto& [x0, y0] = points[segment - 1];
+        const auto& [x1, y1] = points[segment];
+        table_[counts] = y0 + (y1 - y0) * (counts - x0) / (x1 - x0);
+    }
+}
+
+double HIDPointerCalibration::pixelsFor(int counts) const noexcept
+{
+    const int magnitude = std::min(std::abs(counts), kMaxStep);
+    return counts < 0 ? -table_[magnitude] : table_[magnitude];
+}
+
+int HIDPointerCalibration::countsFor(double pixels, int maxStep) const noexcept
+{
+    const int limit = std::clamp(maxStep, 1, kMaxStep);
+    const double magnitude = std::abs(pixels);
+    // table_ is strictly increasing, so the nearest entry is next to the
+    // first one that reaches the wanted distance.
+    const auto end = table_.begin() + limit + 1;
+    auto it = std::lower_bound(table_.begin(), end, magnitude);
+    if (it == end) {
+        --it;
+    } else if (it != table_.begin() && magnitude - *(it - 1) < *it - magnitude) {
+        --it;
+    }
+    const auto counts = static_cast<int>(it - table_.begin());
+    return pixels < 0 ? -counts : counts;
+}
+
+HIDPointerCalibration HIDPointerCalibration::load(const std::string& path)
+{
+    const auto root = YAML::LoadFile(path);
+    std::vector<HIDGainSample> samples;
+    for (const auto& node : root["samples"]) {
+        samples.push_back({node["step"].as<int>(), node["reports"].as<int>(), node["pixels"].as<int>()});
+    }
+    return HIDPointerCalibration(root["host"].as<std::string>(), std::move(samples));
+}
+
+// Written to a temporary file and renamed so a crash never leaves a
+// truncated profile behind.
+void HIDPointerCalibration::save(const std::string& path) const
+{
+    YAML::Emitter out;
+    out << YAML::BeginMap << YAML::Key << "host" << YAML::Value << host_;
+    out << YAML::Key << "samples" << YAML::Value << YAML::BeginSeq;
+    for (const auto& sample : samples_) {
+        out << YAML::Flow << YAML::BeginMap;
+        out << YAML::Key << "step" << YAML::Value << sample.step;
+        out << YAML::Key << "reports" << YAML::Value << sample.reports;
+        out << YAML::Key << "pixels" << YAML::Value << sample.pixels;
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq << YAML::EndMap;
+
+    const auto temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << out.c_str() << "\n";
+        if (!file) {
+            throw std::runtime_error("Failed to write calibration profile " + temporary);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        throw std::runtime_error("Failed to store calibration profile " + path + ": " + error.message());
+    }
+}
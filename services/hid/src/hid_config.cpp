@@ -1,5 +1,7 @@
 #include "hid_config.hpp"
 
+#include "hid_calibration.hpp"
+
 #include <cstdlib>
 #include <filesystem>
 #include <limits>
@@ -78,6 +80,20 @@ uint32_t getUInt32(const YAML::Node& node, std::string_view key, uint32_t fallba
     }
 }
 
+// Delays may be given as <name>_us for sub-millisecond pacing or as the
+// original <name>_ms; the microsecond key wins when both are present.
+uint32_t getDelayUs(const YAML::Node& node, const std::string& name, uint32_t fallback)
+{
+    if (node[name + "_us"]) {
+        return getUInt32(node, name + "_us", fallback);
+    }
+    const auto ms = getUInt32(node, name + "_ms", fallback / 1000);
+    if (ms > std::numeric_limits<uint32_t>::max() / 1000) {
+        throw std::runtime_error("Delay '" + name + "_ms' is out of range");
+    }
+    return ms * 1000;
+}
+
 bool getBool(const YAML::Node& node, std::string_view key, bool fallback)
 {
     if (!node || !node[key.data()]) {
@@ -119,26 +135,85 @@ HIDConfig loadHIDConfig(const std::string& path)
 
         if (const auto keyboardNode = deviceNode["keyboard"]; keyboardNode) {
             config.keyboard.enabled = getBool(keyboardNode, "enabled", config.keyboard.enabled);
+            config.keyboard.layout = keyboardLayoutFromString(
+                getString(keyboardNode, "layout", std::string{keyboardLayoutName(config.keyboard.layout)}));
+            config.keyboard.textCacheBytes = getUInt32(keyboardNode, "text_cache_bytes", config.keyboard.textCacheBytes);
         }
 
         if (const auto mouseNode = deviceNode["mouse"]; mouseNode) {
             config.mouse.enabled = getBool(mouseNode, "enabled", config.mouse.enabled);
+            const auto mode = getString(mouseNode, "mode", config.mouse.absolute ? "absolute" : "relative");
+            if (mode != "relative" && mode != "absolute") {
+                throw std::runtime_error("hid.mouse.mode must be 'relative' or 'absolute'");
+            }
+            config.mouse.absolute = mode == "absolute";
+            config.mouse.screenWidth = getUInt32(mouseNode, "screen_width", config.mouse.screenWidth);
+            config.mouse.screenHeight = getUInt32(mouseNode, "screen_height", config.mouse.screenHeight);
+            if (config.mouse.screenWidth == 0 || config.mouse.screenHeight == 0) {
+                throw std::runtime_error("hid.mouse.screen_width and screen_height must be positive");
+            }
         }
     }
 
     if (const auto httpNode = root["http"]; httpNode) {
         config.http.bindAddress = getString(httpNode, "bind", config.http.bindAddress);
         config.http.port = getUInt16(httpNode, "port", config.http.port);
+        config.http.reactorThreads = getUInt32(httpNode, "reactor_threads", config.http.reactorThreads);
+        config.http.backlog = getUInt32(httpNode, "backlog", config.http.backlog);
+        config.http.maxRequestBytes = getUInt32(httpNode, "max_request_bytes", config.http.maxRequestBytes);
+        config.http.keepAliveTimeoutMs = getUInt32(httpNode, "keepalive_timeout_ms", config.http.keepAliveTimeoutMs);
+        config.http.maxRequestsPerConnection = getUInt32(httpNode, "max_requests_per_connection", config.http.maxRequestsPerConnection);
+        config.http.tcpEnabled = getBool(httpNode, "tcp_enabled", config.http.tcpEnabled);
+        config.http.unixSocket = getString(httpNode, "unix_socket", config.http.unixSocket);
+        config.http.unixSocketMode = getUInt32(httpNode, "unix_socket_mode", config.http.unixSocketMode);
+        if (config.http.reactorThreads == 0) {
+            config.http.reactorThreads = 1;
+        }
+        if (config.http.unixSocketMode > 0777) {
+            throw std::runtime_error("http.unix_socket_mode must be a permission mask such as 0660");
+        }
+        if (!config.http.tcpEnabled && config.http.unixSocket.empty()) {
+            throw std::runtime_error("http.tcp_enabled is false but no http.unix_socket is configured");
+        }
     }
 
     if (const auto safetyNode = root["safety"]; safetyNode) {
-        config.safety.keypressDelayMs = getUInt32(safetyNode, "keypress_delay_ms", config.safety.keypressDelayMs);
-        config.safety.mouseMoveDelayMs = getUInt32(safetyNode, "mouse_move_delay_ms", config.safety.mouseMoveDelayMs);
+        config.safety.keypressDelayUs = getDelayUs(safetyNode, "keypress_delay", config.safety.keypressDelayUs);
+        config.safety.mouseMoveDelayUs = getDelayUs(safetyNode, "mouse_move_delay", config.safety.mouseMoveDelayUs);
         config.safety.mouseStepLimit = getUInt32(safetyNode, "mouse_step_limit", config.safety.mouseStepLimit);
+        config.safety.pointerProfile = trajectoryProfileFromString(
+            getString(safetyNode, "pointer_profile", std::string{trajectoryProfileName(config.safety.pointerProfile)}));
+        config.safety.adaptivePacing = getBool(safetyNode, "adaptive_pacing", config.safety.adaptivePacing);
+        config.safety.minReportIntervalUs = getUInt32(safetyNode, "min_report_interval_us", config.safety.minReportIntervalUs);
         if (config.safety.mouseStepLimit == 0) {
             config.safety.mouseStepLimit = 1;
         }
     }
 
+    if (const auto jobsNode = root["jobs"]; jobsNode) {
+        config.jobs.retainFinished = getUInt32(jobsNode, "retain_finished", config.jobs.retainFinished);
+        config.jobs.maxWaitMs = getUInt32(jobsNode, "max_wait_ms", config.jobs.maxWaitMs);
+        config.jobs.maxQueueDepth = getUInt32(jobsNode, "max_queue_depth", config.jobs.maxQueueDepth);
+        config.jobs.maxQueueDelayMs = getUInt32(jobsNode, "max_queue_delay_ms", config.jobs.maxQueueDelayMs);
+    }
+
+    if (const auto datagramNode = root["datagram"]; datagramNode) {
+        config.datagram.bindAddress = getString(datagramNode, "bind", config.datagram.bindAddress);
+        config.datagram.udpPort = getUInt16(datagramNode, "udp_port", config.datagram.udpPort);
+        config.datagram.unixSocket = getString(datagramNode, "unix_socket", config.datagram.unixSocket);
+        config.datagram.unixSocketMode = getUInt32(datagramNode, "unix_socket_mode", config.datagram.unixSocketMode);
+        if (config.datagram.unixSocketMode > 0777) {
+            throw std::runtime_error("datagram.unix_socket_mode must be a permission mask such as 0660");
+        }
+    }
+
+    if (const auto calibrationNode = root["calibration"]; calibrationNode) {
+        config.calibration.directory = getString(calibrationNode, "directory", config.calibration.directory);
+        config.calibration.host = getString(calibrationNode, "host", config.calibration.host);
+        if (!config.calibration.host.empty() && !isValidCalibrationHost(config.calibration.host)) {
+            throw std::runtime_error("calibration.host must be 1-64 characters of [A-Za-z0-9._-]");
+        }
+    }
+
     return config;
 }
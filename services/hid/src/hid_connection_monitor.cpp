@@ -0,0 +1,210 @@
+#include "hid_connection_monitor.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// From the Linux Bluetooth socket ABI and the Core spec, vol 4 part E, so the
+// service does not need libbluetooth headers.
+constexpr int kAfBluetooth = 31;
+constexpr int kBtProtoHci = 1;
+constexpr int kSolHci = 0;
+constexpr int kHciFilterOption = 2;
+constexpr uint16_t kHciChannelRaw = 0;
+
+constexpr uint8_t kHciEventPacket = 0x04;
+constexpr uint8_t kEventDisconnectionComplete = 0x05;
+constexpr uint8_t kEventLeMeta = 0x3E;
+constexpr uint8_t kLeConnectionComplete = 0x01;
+constexpr uint8_t kLeConnectionUpdateComplete = 0x03;
+constexpr uint8_t kLeEnhancedConnectionComplete = 0x0A;
+
+// Offsets of the Connection_Interval parameter within each LE meta event,
+// counted from the subevent code.
+constexpr size_t kConnectionCompleteIntervalOffset = 12;
+constexpr size_t kEnhancedConnectionCompleteIntervalOffset = 24;
+constexpr size_t kConnectionUpdateIntervalOffset = 4;
+
+constexpr std::chrono::microseconds kIntervalUnit{1250};
+
+struct HciSocketAddress {
+    sa_family_t family;
+    uint16_t device;
+    uint16_t channel;
+};
+
+struct HciFilter {
+    uint32_t typeMask;
+    std::array<uint32_t, 2> eventMask;
+    uint16_t opcode;
+};
+
+uint16_t readLe16(const uint8_t* data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint16_t adapterIndex(const std::string& adapter)
+{
+    if (adapter.size() > 3 && adapter.compare(0, 3, "hci") == 0) {
+        try {
+            return static_cast<uint16_t>(std::stoul(adapter.substr(3)));
+        } catch (const std::exception&) {
+        }
+    }
+    throw std::invalid_argument("Adapter name '" + adapter + "' is not of the form hciN");
+}
+
+} // namespace
+
+HIDConnectionMonitor::~HIDConnectionMonitor()
+{
+    stop();
+}
+
+void HIDConnectionMonitor::start(const std::string& adapter)
+{
+    if (socketFd_ >= 0) {
+        return;
+    }
+
+    const auto device = adapterIndex(adapter);
+    const int fd = ::socket(kAfBluetooth, SOCK_RAW | SOCK_CLOEXEC, kBtProtoHci);
+    if (fd < 0) {
+        std::cerr << "[hid] Connection interval tracking unavailable: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    HciFilter filter{};
+    filter.typeMask = 1U << kHciEventPacket;
+    filter.eventMask[kEventDisconnectionComplete / 32] |= 1U << (kEventDisconnectionComplete % 32);
+    filter.eventMask[kEventLeMeta / 32] |= 1U << (kEventLeMeta % 32);
+    const HciSocketAddress address{kAfBluetooth, device, kHciChannelRaw};
+    if (::setsockopt(fd, kSolHci, kHciFilterOption, &filter, sizeof(filter)) < 0
+        || ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "[hid] Connection interval tracking unavailable on " << adapter << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return;
+    }
+
+    wakeFd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) {
+        ::close(fd);
+        throw std::runtime_error(std::string{"Failed to create connection monitor eventfd: "} + std::strerror(errno));
+    }
+    socketFd_ = fd;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void HIDConnectionMonitor::stop()
+{
+    if (socketFd_ < 0) {
+        return;
+    }
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = ::write(wakeFd_, &one, sizeof(one));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(socketFd_);
+    ::close(wakeFd_);
+    socketFd_ = -1;
+    wakeFd_ = -1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.clear();
+    publish();
+}
+
+std::optional<std::chrono::microseconds> HIDConnectionMonitor::interval() const noexcept
+{
+    const auto us = intervalUs_.load(std::memory_order_relaxed);
+    if (us == 0) {
+        return std::nullopt;
+    }
+    return std::chrono::microseconds(us);
+}
+
+void HIDConnectionMonitor::run()
+{
+    std::array<pollfd, 2> fds{{{socketFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}}};
+    std::array<uint8_t, 260> packet{};
+    while (true) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[hid] Connection monitor poll failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        const auto received = ::recv(socketFd_, packet.data(), packet.size(), MSG_DONTWAIT);
+        if (received > 0) {
+            handleEvent(packet.data(), static_cast<size_t>(received));
+        }
+    }
+}
+
+// Packets are [type][event code][parameter length][parameters...].
+void HIDConnectionMonitor::handleEvent(const uint8_t* packet, size_t size)
+{
+    if (size < 3 || packet[0] != kHciEventPacket || static_cast<size_t>(packet[2]) + 3 > size) {
+        return;
+    }
+    const uint8_t* params = packet + 3;
+    const size_t length = packet[2];
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (packet[1] == kEventDisconnectionComplete) {
+        if (length >= 3 && params[0] == 0) {
+            connections_.erase(readLe16(params + 1) & 0x0FFF);
+            publish();
+        }
+        return;
+    }
+
+    if (length < 4 || params[1] != 0) {
+        return;
+    }
+    size_t offset = 0;
+    switch (params[0]) {
+    case kLeConnectionComplete:
+        offset = kConnectionCompleteIntervalOffset;
+        break;
+    case kLeEnhancedConnectionComplete:
+        offset = kEnhancedConnectionCompleteIntervalOffset;
+        break;
+    case kLeConnectionUpdateComplete:
+        offset = kConnectionUpdateIntervalOffset;
+        break;
+    default:
+        return;
+    }
+    if (length < offset + 2) {
+        return;
+    }
+    const auto handle = static_cast<uint16_t>(readLe16(params + 2) & 0x0FFF);
+    connections_[handle] = kIntervalUnit * readLe16(params + offset);
+    publish();
+}
+
+void HIDConnectionMonitor::publish()
+{
+    std::chrono::microseconds longest{0};
+    for (const auto& [handle, interval] : connections_) {
+        longest = std::max(longest, interval);
+    }
+    intervalUs_.store(longest.count(), std::memory_order_relaxed);
+}
@@ -0,0 +1,401 @@
+#include "hid_datagram.hpp"
+
+#include "hid_metrics.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t kUdpToken = 0;
+constexpr uint64_t kUnixToken = 1;
+constexpr uint64_t kWakeToken = 2;
+constexpr size_t kBatchSize = 32;
+// Room for one byte past a valid datagram so oversized ones are detectable.
+constexpr size_t kReceiveBufferSize = kHIDDatagramSize + 1;
+constexpr size_t kMaxTrackedSenders = 64;
+constexpr size_t kStatsReplySize = kHIDDatagramSize + 7 * sizeof(uint64_t);
+
+uint16_t readLe16(const uint8_t* data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readLe32(const uint8_t* data)
+{
+    return uint32_t{data[0]} | (uint32_t{data[1]} << 8) | (uint32_t{data[2]} << 16) | (uint32_t{data[3]} << 24);
+}
+
+void writeLe64(uint8_t* data, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        data[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+MouseButton buttonFromIndex(int16_t index)
+{
+    switch (index) {
+    case 0:
+        return MouseButton::Left;
+    case 1:
+        return MouseButton::Right;
+    case 2:
+        return MouseButton::Middle;
+    default:
+        throw std::invalid_argument("Unsupported mouse button index " + std::to_string(index));
+    }
+}
+
+} // namespace
+
+bool decodeHIDDatagram(const uint8_t* data, size_t size, HIDDatagramCommand& command) noexcept
+{
+    if (size != kHIDDatagramSize || data[0] != kHIDDatagramVersion || readLe16(data + 2) != 0) {
+        return false;
+    }
+    switch (static_cast<HIDDatagramOpcode>(data[1])) {
+    case HIDDatagramOpcode::MoveRelative:
+    case HIDDatagramOpcode::MoveAbsolute:
+    case HIDDatagramOpcode::Button:
+    case HIDDatagramOpcode::Wheel:
+    case HIDDatagramOpcode::KeyTap:
+    case HIDDatagramOpcode::KeyDown:
+    case HIDDatagramOpcode::KeyUp:
+    case HIDDatagramOpcode::Stats:
+        break;
+    default:
+        return false;
+    }
+
+    command.opcode = static_cast<HIDDatagramOpcode>(data[1]);
+    command.seq = readLe32(data + 4);
+    command.a = static_cast<int16_t>(readLe16(data + 8));
+    command.b = static_cast<int16_t>(readLe16(data + 10));
+    command.ttlUs = readLe32(data + 12);
+    return true;
+}
+
+HIDDatagramServer::HIDDatagramServer(BluetoothHIDServer& hid, const HIDConfig& config)
+    : hid_(hid)
+    , config_(config.datagram)
+{
+}
+
+HIDDatagramServer::~HIDDatagramServer()
+{
+    stop();
+}
+
+void HIDDatagramServer::start()
+{
+    if (running_ || !config_.enabled()) {
+        return;
+    }
+
+    try {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd_ < 0 || wakeFd_ < 0) {
+            throw std::runtime_error(std::string{"Failed to create datagram poller: "} + std::strerror(errno));
+        }
+        if (config_.udpPort != 0) {
+            udpFd_ = openUdpSocket();
+        }
+        if (!config_.unixSocket.empty()) {
+            unixFd_ = openUnixSocket();
+        }
+    } catch (...) {
+        closeSockets();
+        throw;
+    }
+
+    const std::array<std::pair<int, uint64_t>, 3> sources{{{udpFd_, kUdpToken}, {unixFd_, kUnixToken}, {wakeFd_, kWakeToken}}};
+    for (const auto& [fd, token] : sources) {
+        if (fd < 0) {
+            continue;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = token;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+
+    std::cout << "[hid] Datagram commands on";
+    if (udpFd_ >= 0) {
+        std::cout << " udp:" << config_.bindAddress << ":" << config_.udpPort;
+    }
+    if (unixFd_ >= 0) {
+        std::cout << " unix:" << config_.unixSocket;
+    }
+    std::cout << std::endl;
+}
+
+void HIDDatagramServer::stop()
+{
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    const uint64_t value = 1;
+    (void)!::write(wakeFd_, &value, sizeof(value));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeSockets();
+}
+
+HIDDatagramStats HIDDatagramServer::stats() const noexcept
+{
+    const auto& counters = hidMetrics().datagram;
+    HIDDatagramStats stats;
+    stats.received = counters.received.value();
+    stats.accepted = counters.accepted.value();
+    stats.malformed = counters.malformed.value();
+    stats.reordered = counters.reordered.value();
+    stats.lost = counters.lost.value();
+    stats.expired = counters.expired.value();
+    stats.failed = counters.failed.value();
+    return stats;
+}
+
+int HIDDatagramServer::openUdpSocket() const
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.udpPort);
+    if (config_.bindAddress == "0.0.0.0" || config_.bindAddress == "*") {
+        addr.sin_addr.s_addr = INADDR_ANY;
+    } else if (::inet_pton(AF_INET, config_.bindAddress.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid datagram bind address: " + config_.bindAddress);
+    }
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string{"Failed to create UDP socket: "} + std::strerror(errno));
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("UDP bind failed: " + error);
+    }
+    return fd;
+}
+
+int HIDDatagramServer::openUnixSocket() const
+{
+    const auto& path = config_.unixSocket;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    struct stat existing{};
+    if (::lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(path.c_str());
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string{"Failed to create unix datagram socket: "} + std::strerror(errno));
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || ::chmod(path.c_str(), static_cast<mode_t>(config_.unixSocketMode)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("Bind failed for " + path + ": " + error);
+    }
+    return fd;
+}
+
+void HIDDatagramServer::closeSockets()
+{
+    for (int* fd : {&udpFd_, &unixFd_, &epollFd_, &wakeFd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!config_.unixSocket.empty()) {
+        ::unlink(config_.unixSocket.c_str());
+    }
+}
+
+void HIDDatagramServer::run()
+{
+    epoll_event events[3];
+    while (running_) {
+        const int count = ::epoll_wait(epollFd_, events, 3, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[hid] Datagram epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.u64 == kUdpToken) {
+                drain(udpFd_);
+            } else if (events[i].data.u64 == kUnixToken) {
+                drain(unixFd_);
+            }
+        }
+    }
+}
+
+// Receives in batches with recvmmsg; commands in a batch run in arrival
+// order and the TTL is measured from the moment the batch was read.
+void HIDDatagramServer::drain(int fd)
+{
+    std::array<std::array<uint8_t, kReceiveBufferSize>, kBatchSize> buffers;
+    std::array<sockaddr_storage, kBatchSize> addresses;
+    std::array<iovec, kBatchSize> iovecs;
+    std::array<mmsghdr, kBatchSize> messages;
+
+    while (running_) {
+        for (size_t i = 0; i < kBatchSize; ++i) {
+            iovecs[i] = {buffers[i].data(), buffers[i].size()};
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        }
+
+        const int received = ::recvmmsg(fd, messages.data(), kBatchSize, MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "[hid] Datagram receive failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        const auto arrival = Clock::now();
+        hidMetrics().datagram.received.add(static_cast<uint64_t>(received));
+
+        for (int i = 0; i < received; ++i) {
+            const auto& header = messages[i].msg_hdr;
+            HIDDatagramCommand command;
+            if ((header.msg_flags & MSG_TRUNC) != 0 || !decodeHIDDatagram(buffers[i].data(), messages[i].msg_len, command)) {
+                hidMetrics().datagram.malformed.add();
+                continue;
+            }
+
+            if (command.opcode == HIDDatagramOpcode::Stats) {
+                if (header.msg_namelen <= sizeof(sa_family_t)) {
+                    continue; // unbound unix sender; nowhere to reply
+                }
+                const auto snapshot = stats();
+                std::array<uint8_t, kStatsReplySize> reply{};
+                std::memcpy(reply.data(), buffers[i].data(), kHIDDatagramSize);
+                uint8_t* out = reply.data() + kHIDDatagramSize;
+                for (const uint64_t value : {snapshot.received, snapshot.accepted, snapshot.malformed, snapshot.reordered,
+                                             snapshot.lost, snapshot.expired, snapshot.failed}) {
+                    writeLe64(out, value);
+                    out += sizeof(uint64_t);
+                }
+                ::sendto(fd, reply.data(), reply.size(), MSG_DONTWAIT, static_cast<const sockaddr*>(header.msg_name), header.msg_namelen);
+                continue;
+            }
+
+            const std::string sender(static_cast<const char*>(header.msg_name), header.msg_namelen);
+            if (!acceptSequence(sender, command.seq)) {
+                continue;
+            }
+            HIDDeadline deadline;
+            if (command.ttlUs != 0) {
+                deadline = arrival + std::chrono::microseconds(command.ttlUs);
+                if (Clock::now() > *deadline) {
+                    hidMetrics().datagram.expired.add();
+                    continue;
+                }
+            }
+
+            // The deadline is checked again once the execution lock is held,
+            // since a running job can hold it for seconds.
+            try {
+                execute(command, deadline);
+                hidMetrics().datagram.accepted.add();
+            } catch (const HIDDeadlineExpired&) {
+                hidMetrics().datagram.expired.add();
+            } catch (const std::exception& ex) {
+                hidMetrics().datagram.failed.add();
+                std::cerr << "[hid] Datagram command " << command.seq << " failed: " << ex.what() << std::endl;
+            }
+        }
+
+        if (static_cast<size_t>(received) < kBatchSize) {
+            return;
+        }
+    }
+}
+
+bool HIDDatagramServer::acceptSequence(const std::string& sender, uint32_t seq)
+{
+    auto it = lastSeq_.find(sender);
+    if (it == lastSeq_.end() || seq == 0) {
+        if (it == lastSeq_.end() && lastSeq_.size() >= kMaxTrackedSenders) {
+            lastSeq_.clear();
+        }
+        lastSeq_[sender] = seq;
+        return true;
+    }
+
+    // Serial-number arithmetic so that wrap-around at 2^32 is not a reorder.
+    const auto delta = static_cast<int32_t>(seq - it->second);
+    if (delta <= 0) {
+        hidMetrics().datagram.reordered.add();
+        return false;
+    }
+    if (delta > 1) {
+        hidMetrics().datagram.lost.add(static_cast<uint64_t>(delta - 1));
+    }
+    it->second = seq;
+    return true;
+}
+
+void HIDDatagramServer::execute(const HIDDatagramCommand& command, HIDDeadline deadline)
+{
+    switch (command.opcode) {
+    case HIDDatagramOpcode::MoveRelative:
+        hid_.moveRelative(command.a, command.b, deadline);
+        break;
+    case HIDDatagramOpcode::MoveAbsolute:
+        hid_.movePointer(command.a, command.b, {}, deadline);
+        break;
+    case HIDDatagramOpcode::Button:
+        hid_.setButton(buttonFromIndex(command.a), command.b != 0, deadline);
+        break;
+    case HIDDatagramOpcode::Wheel:
+        hid_.scroll(command.a, deadline);
+        break;
+    case HIDDatagramOpcode::KeyTap:
+        hid_.tapKey(static_cast<uint8_t>(command.b), static_cast<uint8_t>(command.a), deadline);
+        break;
+    case HIDDatagramOpcode::KeyDown:
+        hid_.setKey(static_cast<uint8_t>(command.b), static_cast<uint8_t>(command.a), deadline);
+        break;
+    case HIDDatagramOpcode::KeyUp:
+        hid_.setKey(0, 0, deadline);
+        break;
+    case HIDDatagramOpcode::Stats:
+        break;
+    }
+}
@@ -0,0 +1,249 @@
+#include "hid_keyboard_layout.hpp"
+
+#include <array>
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr uint8_t kShift = 0x02;
+constexpr uint8_t kAltGr = 0x40; // right Alt
+
+constexpr char32_t kEuroSign = U'€';
+constexpr char32_t kReplacement = 0xFFFD;
+
+// Dense over Latin-1; the euro sign is the only character beyond it that
+// these layouts type.
+struct LayoutTable {
+    std::array<HIDLayoutKey, 256> keys{};
+    HIDLayoutKey euro{};
+};
+
+constexpr HIDLayoutKey& slot(LayoutTable& table, char32_t codePoint)
+{
+    return codePoint == kEuroSign ? table.euro : table.keys[codePoint];
+}
+
+constexpr void put(LayoutTable& table, char32_t codePoint, uint8_t usage, uint8_t modifiers = 0)
+{
+    slot(table, codePoint) = {{}, {usage, modifiers}};
+}
+
+// chars[i] is typed by usage first + i; NUL leaves that key out.
+constexpr void putRow(LayoutTable& table, std::u32string_view chars, uint8_t first, uint8_t modifiers = 0)
+{
+    for (size_t i = 0; i < chars.size(); ++i) {
+        if (chars[i] != 0) {
+            put(table, chars[i], static_cast<uint8_t>(first + i), modifiers);
+        }
+    }
+}
+
+// The letter printed on each of the keys at usages 0x04..0x1D; other
+// characters are placed separately.
+constexpr void putLetters(LayoutTable& table, std::string_view letters)
+{
+    for (size_t i = 0; i < letters.size(); ++i) {
+        const char32_t letter = static_cast<unsigned char>(letters[i]);
+        if (U'a' <= letter && letter <= U'z') {
+            put(table, letter, static_cast<uint8_t>(0x04 + i));
+            put(table, letter - 0x20, static_cast<uint8_t>(0x04 + i), kShift);
+        }
+    }
+}
+
+// composed[i] is the dead key followed by bases[i]; spacing, the accent on
+// its own, is the dead key followed by Space unless the layout has a key
+// for it (NUL).
+constexpr void putDead(LayoutTable& table, HIDKeyboardStroke dead, char32_t spacing, std::u32string_view composed,
+                       std::u32string_view bases)
+{
+    if (spacing != 0) {
+        slot(table, spacing) = {dead, table.keys[U' '].stroke};
+    }
+    for (size_t i = 0; i < composed.size(); ++i) {
+        slot(table, composed[i]) = {dead, table.keys[bases[i]].stroke};
+    }
+}
+
+constexpr LayoutTable commonTable()
+{
+    LayoutTable table;
+    put(table, U' ', 0x2C);
+    put(table, U'\t', 0x2B);
+    put(table, U'\n', 0x28);
+    put(table, U'\r', 0x28);
+    put(table, U'\b', 0x2A);
+    return table;
+}
+
+constexpr LayoutTable usTable()
+{
+    auto table = commonTable();
+    putLetters(table, "abcdefghijklmnopqrstuvwxyz");
+    putRow(table, U"1234567890", 0x1E);
+    putRow(table, U"!@#$%^&*()", 0x1E, kShift);
+    putRow(table, U"-=[]\\\0;'`,./"sv, 0x2D);
+    putRow(table, U"_+{}|\0:\"~<>?"sv, 0x2D, kShift);
+    return table;
+}
+
+constexpr LayoutTable ukTable()
+{
+    auto table = commonTable();
+    putLetters(table, "abcdefghijklmnopqrstuvwxyz");
+    putRow(table, U"1234567890", 0x1E);
+    putRow(table, U"!\"£$%^&*()", 0x1E, kShift);
+    putRow(table, U"-=[]\0#;'`,./"sv, 0x2D);
+    putRow(table, U"_+{}\0~:@¬<>?"sv, 0x2D, kShift);
+    put(table, U'\\', 0x64);
+    put(table, U'|', 0x64, kShift);
+    put(table, U'€', 0x21, kAltGr);
+    put(table, U'¦', 0x35, kAltGr);
+    constexpr std::u32string_view vowels = U"aeiou";
+    for (size_t i = 0; i < vowels.size(); ++i) {
+        const uint8_t usage = table.keys[vowels[i]].stroke.usage;
+        put(table, U"áéíóú"[i], usage, kAltGr);
+        put(table, U"ÁÉÍÓÚ"[i], usage, kAltGr | kShift);
+    }
+    return table;
+}
+
+constexpr LayoutTable deTable()
+{
+    auto table = commonTable();
+    putLetters(table, "abcdefghijklmnopqrstuvwxzy");
+    putRow(table, U"1234567890", 0x1E);
+    putRow(table, U"!\"§$%&/()=", 0x1E, kShift);
+    putRow(table, U"\0²³\0\0\0{[]}"sv, 0x1E, kAltGr);
+    putRow(table, U"ß\0ü+\0#öä\0,.-"sv, 0x2D);
+    putRow(table, U"?\0Ü*\0'ÖÄ°;:_"sv, 0x2D, kShift);
+    put(table, U'\\', 0x2D, kAltGr);
+    put(table, U'~', 0x30, kAltGr);
+    put(table, U'<', 0x64);
+    put(table, U'>', 0x64, kShift);
+    put(table, U'|', 0x64, kAltGr);
+    put(table, U'@', 0x14, kAltGr);
+    put(table, U'€', 0x08, kAltGr);
+    put(table, U'µ', 0x10, kAltGr);
+    putDead(table, {0x2E, 0}, U'´', U"áéíóúýÁÉÍÓÚÝ", U"aeiouyAEIOUY");
+    putDead(table, {0x2E, kShift}, U'`', U"àèìòùÀÈÌÒÙ", U"aeiouAEIOU");
+    putDead(table, {0x35, 0}, U'^', U"âêîôûÂÊÎÔÛ", U"aeiouAEIOU");
+    return table;
+}
+
+constexpr LayoutTable frTable()
+{
+    auto table = commonTable();
+    putLetters(table, "qbcdefghijkl,noparstuvzxyw");
+    put(table, U'm', 0x33);
+    put(table, U'M', 0x33, kShift);
+    put(table, U',', 0x10);
+    put(table, U'?', 0x10, kShift);
+    putRow(table, U"&é\"'(-è_çà", 0x1E);
+    putRow(table, U"1234567890", 0x1E, kShift);
+    putRow(table, U"\0\0#{[|\0\\^@"sv, 0x1E, kAltGr);
+    putRow(table, U")=\0$\0*\0ù²;:!"sv, 0x2D);
+    putRow(table, U"°+\0£\0µ\0%\0./§"sv, 0x2D, kShift);
+    put(table, U']', 0x2D, kAltGr);
+    put(table, U'}', 0x2E, kAltGr);
+    put(table, U'¤', 0x30, kAltGr);
+    put(table, U'<', 0x64);
+    put(table, U'>', 0x64, kShift);
+    put(table, U'€', 0x08, kAltGr);
+    putDead(table, {0x2F, 0}, U'\0', U"âêîôûÂÊÎÔÛ", U"aeiouAEIOU");
+    putDead(table, {0x2F, kShift}, U'¨', U"äëïöüÿÄËÏÖÜ", U"aeiouyAEIOU");
+    putDead(table, {0x1F, kAltGr}, U'~', U"ãõñÃÕÑ", U"aonAON");
+    putDead(table, {0x24, kAltGr}, U'`', U"ìòÀÈÌÒÙ", U"ioAEIOU");
+    return table;
+}
+
+constexpr std::array<LayoutTable, 4> kLayouts{usTable(), ukTable(), deTable(), frTable()};
+
+} // namespace
+
+std::string_view keyboardLayoutName(HIDKeyboardLayout layout)
+{
+    switch (layout) {
+    case HIDKeyboardLayout::US:
+        return "us";
+    case HIDKeyboardLayout::UK:
+        return "uk";
+    case HIDKeyboardLayout::DE:
+        return "de";
+    case HIDKeyboardLayout::FR:
+        return "fr";
+    }
+    return "us";
+}
+
+HIDKeyboardLayout keyboardLayoutFromString(std::string_view name)
+{
+    if (name == "us") {
+        return HIDKeyboardLayout::US;
+    }
+    if (name == "uk") {
+        return HIDKeyboardLayout::UK;
+    }
+    if (name == "de") {
+        return HIDKeyboardLayout::DE;
+    }
+    if (name == "fr") {
+        return HIDKeyboardLayout::FR;
+    }
+    throw std::invalid_argument("keyboard layout must be one of us, uk, de, fr");
+}
+
+HIDLayoutKey lookupKeyboardKey(HIDKeyboardLayout layout, char32_t codePoint) noexcept
+{
+    const auto& table = kLayouts[static_cast<size_t>(layout)];
+    if (codePoint < table.keys.size()) {
+        return table.keys[codePoint];
+    }
+    return codePoint == kEuroSign ? table.euro : HIDLayoutKey{};
+}
+
+char32_t decodeUtf8(std::string_view text, size_t& pos) noexcept
+{
+    const auto lead = static_cast<unsigned char>(text[pos]);
+    if (lead < 0x80) {
+        ++pos;
+        return lead;
+    }
+
+    size_t length = 0;
+    char32_t codePoint = 0;
+    char32_t minimum = 0;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        codePoint = lead & 0x1F;
+        minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        codePoint = lead & 0x0F;
+        minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        codePoint = lead & 0x07;
+        minimum = 0x10000;
+    }
+    if (length == 0 || text.size() - pos < length) {
+        ++pos;
+        return kReplacement;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        const auto next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            ++pos;
+            return kReplacement;
+        }
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    if (codePoint < minimum || codePoint > 0x10FFFF || (0xD800 <= codePoint && codePoint <= 0xDFFF)) {
+        ++pos;
+        return kReplacement;
+    }
+    pos += length;
+    return codePoint;
+}
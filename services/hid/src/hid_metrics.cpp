@@ -0,0 +1,224 @@
+#include "hid_metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr std::array<std::string_view, LatencyHistogram::kBoundsUs.size()> kBoundLabels{
+    "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025",
+    "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5", "10"};
+
+constexpr std::array<std::string_view, 5> kStatusClasses{"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+void appendHeader(std::string& out, std::string_view name, std::string_view type, std::string_view help)
+{
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void appendSample(std::string& out, std::string_view name, std::string_view labels, uint64_t value)
+{
+    out.append(name);
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.append(" ").append(std::to_string(value)).append("\n");
+}
+
+std::string label(std::string_view key, std::string_view value)
+{
+    std::string out;
+    out.append(key).append("=\"").append(value).append("\"");
+    return out;
+}
+
+} // namespace
+
+void LatencyHistogram::observe(std::chrono::nanoseconds elapsed) noexcept
+{
+    const auto ns = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+    const auto us = ns / 1000;
+    const auto bucket = static_cast<size_t>(std::lower_bound(kBoundsUs.begin(), kBoundsUs.end(), us) - kBoundsUs.begin());
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    sumNs_.fetch_add(ns, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::render(std::string& out, std::string_view name, std::string_view labels) const
+{
+    const std::string bucketName = std::string{name} + "_bucket";
+    const std::string prefix = labels.empty() ? std::string{} : std::string{labels} + ",";
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kBoundsUs.size(); ++i) {
+        cumulative += buckets_[i].load(std::memory_order_relaxed);
+        appendSample(out, bucketName, prefix + label("le", kBoundLabels[i]), cumulative);
+    }
+    cumulative += buckets_[kBoundsUs.size()].load(std::memory_order_relaxed);
+    appendSample(out, bucketName, prefix + label("le", "+Inf"), cumulative);
+
+    char sum[32];
+    std::snprintf(sum, sizeof(sum), "%.9f", static_cast<double>(sumNs_.load(std::memory_order_relaxed)) / 1e9);
+    out.append(name).append("_sum");
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.append(" ").append(sum).append("\n");
+    // Report the bucket total as the count so the series stays self-consistent
+    // under concurrent observation.
+    appendSample(out, std::string{name} + "_count", labels, cumulative);
+}
+
+std::string_view endpointName(HIDEndpoint endpoint)
+{
+    switch (endpoint) {
+    case HIDEndpoint::Healthz:
+        return "healthz";
+    case HIDEndpoint::Metrics:
+        return "metrics";
+    case HIDEndpoint::Text:
+        return "text";
+    case HIDEndpoint::Click:
+        return "click";
+    case HIDEndpoint::Move:
+        return "move";
+    case HIDEndpoint::Batch:
+        return "batch";
+    case HIDEndpoint::Jobs:
+        return "jobs";
+    case HIDEndpoint::Stream:
+        return "stream";
+    case HIDEndpoint::Events:
+        return "events";
+    case HIDEndpoint::Release:
+        return "release";
+    case HIDEndpoint::Calibration:
+        return "calibration";
+    case HIDEndpoint::Unknown:
+    case HIDEndpoint::Count:
+        break;
+    }
+    return "unknown";
+}
+
+std::string_view reportChannelName(HIDReportChannel channel)
+{
+    switch (channel) {
+    case HIDReportChannel::Keyboard:
+        return "keyboard";
+    case HIDReportChannel::BootKeyboard:
+        return "boot_keyboard";
+    case HIDReportChannel::Mouse:
+        return "mouse";
+    case HIDReportChannel::BootMouse:
+        return "boot_mouse";
+    case HIDReportChannel::AbsolutePointer:
+        return "absolute_pointer";
+    case HIDReportChannel::Count:
+        break;
+    }
+    return "unknown";
+}
+
+void HIDMetrics::recordRequest(HIDEndpoint endpoint, int statusCode, std::chrono::nanoseconds elapsed) noexcept
+{
+    const auto index = static_cast<size_t>(endpoint);
+    const auto statusClass = static_cast<size_t>(std::clamp(statusCode / 100, 1, 5) - 1);
+    requests[index][statusClass].add();
+    requestLatency[index].observe(elapsed);
+}
+
+void HIDMetrics::render(std::string& out) const
+{
+    appendHeader(out, "jadeai_hid_http_requests_total", "counter", "HTTP requests by endpoint and status class.");
+    for (size_t e = 0; e < kEndpointCount; ++e) {
+        for (size_t c = 0; c < kStatusClasses.size(); ++c) {
+            const auto value = requests[e][c].value();
+            if (value != 0) {
+                appendSample(out, "jadeai_hid_http_requests_total",
+                             label("endpoint", endpointName(static_cast<HIDEndpoint>(e))) + "," + label("code", kStatusClasses[c]), value);
+            }
+        }
+    }
+
+    appendHeader(out, "jadeai_hid_http_request_duration_seconds", "histogram", "Time from request parsed until its response is handed to the socket.");
+    for (size_t e = 0; e < kEndpointCount; ++e) {
+        requestLatency[e].render(out, "jadeai_hid_http_request_duration_seconds", label("endpoint", endpointName(static_cast<HIDEndpoint>(e))));
+    }
+
+    appendHeader(out, "jadeai_hid_execution_lock_wait_seconds", "histogram", "Time spent waiting for the HID execution lock.");
+    executionWait.render(out, "jadeai_hid_execution_lock_wait_seconds", {});
+
+    appendHeader(out, "jadeai_hid_gatt_notify_duration_seconds", "histogram", "Time inside GATT value update and PropertiesChanged emission.");
+    for (size_t c = 0; c < kReportChannelCount; ++c) {
+        notifyDuration[c].render(out, "jadeai_hid_gatt_notify_duration_seconds", label("characteristic", reportChannelName(static_cast<HIDReportChannel>(c))));
+    }
+
+    appendHeader(out, "jadeai_hid_reports_total", "counter", "Input reports emitted to subscribed hosts.");
+    for (size_t c = 0; c < kReportChannelCount; ++c) {
+        appendSample(out, "jadeai_hid_reports_total", label("characteristic", reportChannelName(static_cast<HIDReportChannel>(c))), reports[c].value());
+    }
+
+    appendHeader(out, "jadeai_hid_report_routes_total", "counter", "Input reports by the protocol route they were sent on.");
+    const std::array<std::pair<std::string_view, const MetricCounter*>, 4> routeCounters{{
+        {"report", &routes.report},
+        {"boot", &routes.boot},
+        {"unsubscribed", &routes.unsubscribed},
+        {"dropped", &routes.dropped},
+    }};
+    for (const auto& [name, counter] : routeCounters) {
+        appendSample(out, "jadeai_hid_report_routes_total", label("route", name), counter->value());
+    }
+
+    appendHeader(out, "jadeai_hid_notifying", "gauge", "Whether the host has enabled notifications on the characteristic.");
+    for (size_t c = 0; c < kReportChannelCount; ++c) {
+        appendSample(out, "jadeai_hid_notifying", label("characteristic", reportChannelName(static_cast<HIDReportChannel>(c))),
+                     static_cast<uint64_t>(notifying[c].value()));
+    }
+
+    appendHeader(out, "jadeai_hid_unsupported_characters_total", "counter", "Characters dropped by sendText because no key mapping exists.");
+    appendSample(out, "jadeai_hid_unsupported_characters_total", {}, unsupportedCharacters.value());
+
+    appendHeader(out, "jadeai_hid_text_cache_requests_total", "counter", "Typed texts served from, or compiled into, the keystroke sequence cache.");
+    appendSample(out, "jadeai_hid_text_cache_requests_total", label("result", "hit"), textCacheHits.value());
+    appendSample(out, "jadeai_hid_text_cache_requests_total", label("result", "miss"), textCacheMisses.value());
+
+    appendHeader(out, "jadeai_hid_text_cache_bytes", "gauge", "Memory held by cached keystroke sequences.");
+    appendSample(out, "jadeai_hid_text_cache_bytes", {}, static_cast<uint64_t>(textCacheBytes.value()));
+
+    appendHeader(out, "jadeai_hid_pacing_slip_seconds", "histogram", "How late each paced report went out relative to its scheduled deadline.");
+    pacingSlip.render(out, "jadeai_hid_pacing_slip_seconds", {});
+
+    appendHeader(out, "jadeai_hid_pacing_resyncs_total", "counter", "Report schedules re-anchored after falling more than one interval behind.");
+    appendSample(out, "jadeai_hid_pacing_resyncs_total", {}, pacingResyncs.value());
+
+    appendHeader(out, "jadeai_hid_pointer_retargets_total", "counter", "In-flight pointer moves redirected to a newer target.");
+    appendSample(out, "jadeai_hid_pointer_retargets_total", {}, pointerRetargets.value());
+
+    appendHeader(out, "jadeai_hid_pointer_moves_superseded_total", "counter", "Queued pointer moves skipped because a newer target replaced them.");
+    appendSample(out, "jadeai_hid_pointer_moves_superseded_total", {}, pointerSuperseded.value());
+
+    appendHeader(out, "jadeai_hid_action_queue_rejections_total", "counter", "Actions refused by queue admission control.");
+    appendSample(out, "jadeai_hid_action_queue_rejections_total", {}, queueRejections.value());
+
+    appendHeader(out, "jadeai_hid_datagrams_total", "counter", "Binary datagram commands by outcome.");
+    const std::array<std::pair<std::string_view, const MetricCounter*>, 7> outcomes{{
+        {"received", &datagram.received},
+        {"accepted", &datagram.accepted},
+        {"malformed", &datagram.malformed},
+        {"reordered", &datagram.reordered},
+        {"lost", &datagram.lost},
+        {"expired", &datagram.expired},
+        {"failed", &datagram.failed},
+    }};
+    for (const auto& [name, counter] : outcomes) {
+        appendSample(out, "jadeai_hid_datagrams_total", label("result", name), counter->value());
+    }
+}
+
+HIDMetrics& hidMetrics()
+{
+    static HIDMetrics metrics;
+    return metrics;
+}
@@ -0,0 +1,41 @@
+#include "hid_pacer.hpp"
+
+#include "hid_metrics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+std::chrono::nanoseconds HIDPacer::now() noexcept
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+std::chrono::nanoseconds HIDPacer::sleepUntil(std::chrono::nanoseconds deadline) noexcept
+{
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(deadline);
+    const timespec target{static_cast<time_t>(seconds.count()), static_cast<long>((deadline - seconds).count())};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+    }
+    return now();
+}
+
+void HIDPacer::restart() noexcept
+{
+    deadline_ = std::max(deadline_, now());
+}
+
+void HIDPacer::advance(std::chrono::nanoseconds interval) noexcept
+{
+    if (interval.count() <= 0) {
+        return;
+    }
+    deadline_ += interval;
+    const auto current = now();
+    if (current - deadline_ > interval) {
+        hidMetrics().pacingResyncs.add();
+        deadline_ = current;
+    }
+}
@@ -0,0 +1,114 @@
+#include "hid_report_ring.hpp"
+
+HIDReportRingClosed::HIDReportRingClosed()
+    : std::runtime_error("HID report ring is closed")
+{
+}
+
+HIDReportRing::HIDReportRing() noexcept
+{
+    for (size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+uint64_t HIDReportRing::push(const HIDReportRecord& record)
+{
+    uint64_t ticket = 0;
+    while (true) {
+        if (closed_.load(std::memory_order_seq_cst)) {
+            throw HIDReportRingClosed();
+        }
+        const auto retired = retired_.load(std::memory_order_acquire);
+        if (tryPush(record, ticket)) {
+            break;
+        }
+        retired_.wait(retired, std::memory_order_acquire);
+    }
+    published_.fetch_add(1, std::memory_order_release);
+    published_.notify_one();
+    // The claim and this load pair with close() and the consumer's tail_
+    // check in pop(): a claim made before the ring was seen closed is always
+    // popped, so its ticket is safe to wait on. A later one may be dropped.
+    if (closed_.load(std::memory_order_seq_cst)) {
+        throw HIDReportRingClosed();
+    }
+    return ticket;
+}
+
+bool HIDReportRing::pop(HIDReportRecord& record)
+{
+    while (true) {
+        const auto published = published_.load(std::memory_order_acquire);
+        if (tryPop(record)) {
+            return true;
+        }
+        // A claimed slot that is not published yet will be, so keep waiting
+        // for it even when closed.
+        if (closed_.load(std::memory_order_seq_cst) && tail_.load(std::memory_order_seq_cst) == head_) {
+            return false;
+        }
+        published_.wait(published, std::memory_order_acquire);
+    }
+}
+
+void HIDReportRing::retire() noexcept
+{
+    retired_.store(head_, std::memory_order_release);
+    retired_.notify_all();
+}
+
+void HIDReportRing::close() noexcept
+{
+    closed_.store(true, std::memory_order_seq_cst);
+    published_.fetch_add(1, std::memory_order_release);
+    published_.notify_all();
+    // Producers blocked on retired_ wake at the consumer's next retire(),
+    // which draining guarantees, and then throw.
+}
+
+void HIDReportRing::awaitRetired(uint64_t ticket) const
+{
+    auto retired = retired_.load(std::memory_order_acquire);
+    while (retired < ticket) {
+        if (closed_.load(std::memory_order_acquire)) {
+            throw HIDReportRingClosed();
+        }
+        retired_.wait(retired, std::memory_order_acquire);
+        retired = retired_.load(std::memory_order_acquire);
+    }
+}
+
+bool HIDReportRing::tryPush(const HIDReportRecord& record, uint64_t& ticket) noexcept
+{
+    auto pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        auto& slot = slots_[pos & kMask];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                ticket = pos + 1;
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool HIDReportRing::tryPop(HIDReportRecord& record) noexcept
+{
+    auto& slot = slots_[head_ & kMask];
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(head_ + kCapacity, std::memory_order_release);
+    ++head_;
+    return true;
+}
@@ -3,55 +3,6 @@
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
-#include <unordered_map>
-
-namespace {
-
-constexpr uint8_t kLeftShift = 0x02;
-
-std::optional<HIDKeyboardStroke> lookupFromTable(char ch)
-{
-    static const std::unordered_map<char, HIDKeyboardStroke> table = {
-        {'1', {0x1E, 0x00}}, {'2', {0x1F, 0x00}}, {'3', {0x20, 0x00}}, {'4', {0x21, 0x00}},
-        {'5', {0x22, 0x00}}, {'6', {0x23, 0x00}}, {'7', {0x24, 0x00}}, {'8', {0x25, 0x00}},
-        {'9', {0x26, 0x00}}, {'0', {0x27, 0x00}},
-        {'-', {0x2D, 0x00}}, {'=', {0x2E, 0x00}}, {'[', {0x2F, 0x00}}, {']', {0x30, 0x00}},
-        {'\\', {0x31, 0x00}}, {';', {0x33, 0x00}}, {'\'', {0x34, 0x00}}, {'`', {0x35, 0x00}},
-        {',', {0x36, 0x00}}, {'.', {0x37, 0x00}}, {'/', {0x38, 0x00}},
-        {'!', {0x1E, kLeftShift}}, {'@', {0x1F, kLeftShift}}, {'#', {0x20, kLeftShift}},
-        {'$', {0x21, kLeftShift}}, {'%', {0x22, kLeftShift}}, {'^', {0x23, kLeftShift}},
-        {'&', {0x24, kLeftShift}}, {'*', {0x25, kLeftShift}}, {'(', {0x26, kLeftShift}},
-        {')', {0x27, kLeftShift}}, {'_', {0x2D, kLeftShift}}, {'+', {0x2E, kLeftShift}},
-        {'{', {0x2F, kLeftShift}}, {'}', {0x30, kLeftShift}}, {'|', {0x31, kLeftShift}},
-        {':', {0x33, kLeftShift}}, {'"', {0x34, kLeftShift}}, {'~', {0x35, kLeftShift}},
-        {'<', {0x36, kLeftShift}}, {'>', {0x37, kLeftShift}}, {'?', {0x38, kLeftShift}},
-        {' ', {0x2C, 0x00}}, {'\t', {0x2B, 0x00}}, {'\n', {0x28, 0x00}}, {'\r', {0x28, 0x00}},
-        {'\b', {0x2A, 0x00}},
-    };
-
-    if (auto it = table.find(ch); it != table.end()) {
-        return it->second;
-    }
-    return std::nullopt;
-}
-
-} // namespace
-
-std::optional<HIDKeyboardStroke> lookupKeyboardStroke(char ch)
-{
-    if ('a' <= ch && ch <= 'z') {
-        return HIDKeyboardStroke{static_cast<uint8_t>(0x04 + (ch - 'a')), 0x00};
-    }
-    if ('A' <= ch && ch <= 'Z') {
-        return HIDKeyboardStroke{static_cast<uint8_t>(0x04 + (ch - 'A')), kLeftShift};
-    }
-
-    if (auto stroke = lookupFromTable(ch); stroke.has_value()) {
-        return stroke;
-    }
-
-    return std::nullopt;
-}
 
 std::array<uint8_t, 9> makeKeyboardReport(uint8_t modifiers, uint8_t keycode)
 {
@@ -70,6 +21,53 @@ const std::array<uint8_t, 9>& makeKeyboardReleaseReport()
     return report;
 }
 
+HIDTypingEncoder::Reports HIDTypingEncoder::type(HIDKeyboardStroke stroke) noexcept
+{
+    constexpr size_t kFirstKey = 3;
+    Reports out;
+    const auto keys = report_.begin() + kFirstKey;
+    const bool repeat = std::find(keys, report_.end(), stroke.usage) != report_.end();
+    if (repeat) {
+        std::fill(keys, report_.end(), 0);
+        out.data[out.count++] = report_;
+    }
+
+    // Slots hold [previous, newest]; shift the newest down and add this key.
+    const uint8_t previous = report_[kFirstKey + 1] != 0 ? report_[kFirstKey + 1] : report_[kFirstKey];
+    std::fill(keys, report_.end(), 0);
+    report_[1] = stroke.modifiers;
+    if (previous != 0) {
+        report_[kFirstKey] = previous;
+        report_[kFirstKey + 1] = stroke.usage;
+    } else {
+        report_[kFirstKey] = stroke.usage;
+    }
+    out.data[out.count++] = report_;
+    return out;
+}
+
+HIDTypingEncoder::Reports HIDTypingEncoder::type(const HIDLayoutKey& key) noexcept
+{
+    if (key.dead.usage == 0) {
+        return type(key.stroke);
+    }
+    auto out = type(key.dead);
+    const auto base = type(key.stroke);
+    for (size_t i = 0; i < base.count; ++i) {
+        out.data[out.count++] = base.data[i];
+    }
+    return out;
+}
+
+std::optional<std::array<uint8_t, 9>> HIDTypingEncoder::finish() noexcept
+{
+    if (report_ == makeKeyboardReleaseReport()) {
+        return std::nullopt;
+    }
+    report_ = makeKeyboardReleaseReport();
+    return report_;
+}
+
 std::array<uint8_t, 5> makeMouseReport(uint8_t buttons, int8_t dx, int8_t dy, int8_t wheel)
 {
     std::array<uint8_t, 5> report{};
@@ -81,6 +79,11 @@ std::array<uint8_t, 5> makeMouseReport(uint8_t buttons, int8_t dx, int8_t dy, in
     return report;
 }
 
+std::array<uint8_t, 6> makeAbsolutePointerReport(uint8_t buttons, uint16_t x, uint16_t y)
+{
+    return {0x03, buttons, static_cast<uint8_t>(x & 0xFF), static_cast<uint8_t>(x >> 8), static_cast<uint8_t>(y & 0xFF), static_cast<uint8_t>(y >> 8)};
+}
+
 uint8_t mouseButtonMask(MouseButton button)
 {
     switch (button) {
@@ -0,0 +1,94 @@
+#include "hid_text_cache.hpp"
+
+#include "hid_metrics.hpp"
+#include "hid_reports.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+size_t HIDCompiledText::bytes() const noexcept
+{
+    return sizeof(*this) + reports.size() * sizeof(reports[0]) + steps.size() * sizeof(steps[0]);
+}
+
+HIDCompiledText compileText(const std::string& text, HIDKeyboardLayout layout)
+{
+    HIDCompiledText compiled;
+    compiled.reports.reserve(text.size() + 1);
+    compiled.steps.reserve(text.size());
+    HIDTypingEncoder encoder;
+    char32_t firstUnsupported = 0;
+    for (size_t pos = 0; pos < text.size();) {
+        const char32_t codePoint = decodeUtf8(text, pos);
+        if (codePoint == U'\r') {
+            continue; // treat CR as newline handled by '\n'
+        }
+        const auto key = lookupKeyboardKey(layout, codePoint);
+        if (!key.mapped()) {
+            if (compiled.unsupported++ == 0) {
+                firstUnsupported = codePoint;
+            }
+            continue;
+        }
+        const auto reports = encoder.type(key);
+        compiled.reports.insert(compiled.reports.end(), reports.data.begin(), reports.data.begin() + reports.count);
+        compiled.steps.push_back({static_cast<uint32_t>(compiled.reports.size()), static_cast<uint32_t>(pos)});
+    }
+    if (const auto release = encoder.finish()) {
+        compiled.reports.push_back(*release);
+    }
+    if (compiled.unsupported != 0) {
+        char first[16];
+        std::snprintf(first, sizeof(first), "U+%04X", static_cast<unsigned>(firstUnsupported));
+        std::cerr << "[hid] Skipping " << compiled.unsupported << " character(s) the " << keyboardLayoutName(layout)
+                  << " layout cannot type, first " << first << std::endl;
+    }
+    return compiled;
+}
+
+HIDTextCache::HIDTextCache(size_t capacityBytes, HIDKeyboardLayout layout)
+    : capacity_(capacityBytes)
+    , layout_(layout)
+{
+}
+
+std::shared_ptr<const HIDCompiledText> HIDTextCache::get(const std::string& text, bool record)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const auto it = index_.find(text); it != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            if (record) {
+                auto& counter = it->second->recorded ? hidMetrics().textCacheHits : hidMetrics().textCacheMisses;
+                counter.add();
+                it->second->recorded = true;
+            }
+            return it->second->compiled;
+        }
+    }
+    if (record) {
+        hidMetrics().textCacheMisses.add();
+    }
+
+    auto compiled = std::make_shared<const HIDCompiledText>(compileText(text, layout_));
+    const size_t bytes = compiled->bytes() + text.size();
+    if (bytes > capacity_) {
+        return compiled;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto it = index_.find(text); it != index_.end()) {
+        return it->second->compiled;
+    }
+    entries_.push_front({text, compiled, bytes, record});
+    index_.emplace(entries_.front().text, entries_.begin());
+    bytes_ += bytes;
+    while (bytes_ > capacity_) {
+        const auto& victim = entries_.back();
+        bytes_ -= victim.bytes;
+        index_.erase(victim.text);
+        entries_.pop_back();
+    }
+    hidMetrics().textCacheBytes.set(static_cast<int64_t>(bytes_));
+    return compiled;
+}
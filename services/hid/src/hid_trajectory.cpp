@@ -0,0 +1,145 @@
+#include "hid_trajectory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Peak velocity of the minimum-jerk profile relative to its mean.
+constexpr double kMinimumJerkPeak = 1.875;
+
+double minimumJerk(double t)
+{
+    const double t3 = t * t * t;
+    return t3 * (10.0 - 15.0 * t + 6.0 * t * t);
+}
+
+double fraction(HIDTrajectoryProfile profile, size_t step, size_t count)
+{
+    const double t = static_cast<double>(step) / static_cast<double>(count);
+    return profile == HIDTrajectoryProfile::MinimumJerk ? minimumJerk(t) : t;
+}
+
+// Rounds each cumulative position rather than each step, so rounding error
+// never accumulates and the last step lands exactly on the target.
+int position(HIDTrajectoryProfile profile, int distance, size_t step, size_t count)
+{
+    return static_cast<int>(std::lround(distance * fraction(profile, step, count)));
+}
+
+bool withinLimit(HIDTrajectoryProfile profile, int dx, int dy, int maxStep, size_t count)
+{
+    int x = 0;
+    int y = 0;
+    for (size_t i = 1; i <= count; ++i) {
+        const int nextX = position(profile, dx, i, count);
+        const int nextY = position(profile, dy, i, count);
+        if (std::abs(nextX - x) > maxStep || std::abs(nextY - y) > maxStep) {
+            return false;
+        }
+        x = nextX;
+        y = nextY;
+    }
+    return true;
+}
+
+int clampStep(int maxStep)
+{
+    return std::clamp(maxStep, 1, 127);
+}
+
+size_t stepCount(HIDTrajectoryProfile profile, int dx, int dy, int maxStep)
+{
+    const int distance = std::max(std::abs(dx), std::abs(dy));
+    if (distance == 0) {
+        return 0;
+    }
+    auto count = static_cast<size_t>((distance + maxStep - 1) / maxStep);
+    if (profile == HIDTrajectoryProfile::Linear) {
+        return count;
+    }
+    // Start from the analytic bound; rounding may push a step over the limit.
+    count = std::max(count, static_cast<size_t>(std::ceil(kMinimumJerkPeak * distance / maxStep)));
+    while (!withinLimit(profile, dx, dy, maxStep, count)) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+std::string_view trajectoryProfileName(HIDTrajectoryProfile profile)
+{
+    switch (profile) {
+    case HIDTrajectoryProfile::Linear:
+        return "linear";
+    case HIDTrajectoryProfile::MinimumJerk:
+        return "minimum_jerk";
+    }
+    return "linear";
+}
+
+HIDTrajectoryProfile trajectoryProfileFromString(std::string_view name)
+{
+    if (name == "linear") {
+        return HIDTrajectoryProfile::Linear;
+    }
+    if (name == "minimum_jerk") {
+        return HIDTrajectoryProfile::MinimumJerk;
+    }
+    throw std::invalid_argument("pointer profile must be one of linear, minimum_jerk");
+}
+
+void planTrajectory(HIDTrajectoryProfile profile, int dx, int dy, int maxStep, std::vector<HIDPointerStep>& steps,
+                    const HIDPointerCalibration* calibration)
+{
+    maxStep = clampStep(maxStep);
+    const int maxPixels = calibration ? std::max(1, static_cast<int>(calibration->pixelsFor(maxStep))) : maxStep;
+    const size_t count = stepCount(profile, dx, dy, maxPixels);
+    steps.clear();
+    steps.reserve(count);
+    int x = 0;
+    int y = 0;
+    double sentX = 0.0;
+    double sentY = 0.0;
+    for (size_t i = 1; i <= count; ++i) {
+        const int nextX = position(profile, dx, i, count);
+        const int nextY = position(profile, dy, i, count);
+        HIDPointerStep step{0, 0, nextX - x, nextY - y};
+        if (calibration) {
+            step.dx = static_cast<int8_t>(calibration->countsFor(nextX - sentX, maxStep));
+            step.dy = static_cast<int8_t>(calibration->countsFor(nextY - sentY, maxStep));
+        } else {
+            step.dx = static_cast<int8_t>(step.pixelsX);
+            step.dy = static_cast<int8_t>(step.pixelsY);
+        }
+        // The slow ends of a minimum-jerk move, or sub-count distances under
+        // a calibration, can round to no motion; fold them into a neighbour.
+        if (step.dx == 0 && step.dy == 0) {
+            if (i == count && !steps.empty()) {
+                steps.back().pixelsX += step.pixelsX;
+                steps.back().pixelsY += step.pixelsY;
+            }
+            continue;
+        }
+        if (calibration) {
+            sentX += calibration->pixelsFor(step.dx);
+            sentY += calibration->pixelsFor(step.dy);
+        }
+        steps.push_back(step);
+        x = nextX;
+        y = nextY;
+    }
+}
+
+size_t trajectoryLength(HIDTrajectoryProfile profile, int dx, int dy, int maxStep, const HIDPointerCalibration* calibration)
+{
+    if (profile == HIDTrajectoryProfile::Linear && !calibration) {
+        return stepCount(profile, dx, dy, clampStep(maxStep));
+    }
+    std::vector<HIDPointerStep> steps;
+    planTrajectory(profile, dx, dy, maxStep, steps, calibration);
+    return steps.size();
+}
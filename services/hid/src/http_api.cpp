@@ -1,49 +1,829 @@
 #include "http_api.hpp"
 
+#include "hid_metrics.hpp"
 #include "hid_reports.hpp"
-
-#include <yaml-cpp/yaml.h>
+#include "http_codec.hpp"
+#include "json_decoder.hpp"
+#include "websocket.hpp"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <cerrno>
-#include <cctype>
+#include <charconv>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
+#include <functional>
 #include <iostream>
 #include <map>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
 #include <string>
-#include <strings.h>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 namespace {
-std::string trim(std::string value)
+
+constexpr uint64_t kListenerToken = 0;
+constexpr uint64_t kUnixListenerToken = 1;
+constexpr uint64_t kWakeToken = 2;
+constexpr uint64_t kFirstConnectionId = 3;
+constexpr int kMaxEpollEvents = 64;
+constexpr int kMaxSweepIntervalMs = 1000;
+constexpr size_t kReadChunkBytes = 4096;
+constexpr auto kWebSocketIdleTimeout = std::chrono::seconds(60);
+constexpr auto kEventStreamHeartbeat = std::chrono::seconds(15);
+constexpr size_t kMaxEventBacklogBytes = 1 << 20;
+
+constexpr std::string_view kJsonContentType{"application/json"};
+constexpr std::string_view kEventStreamHead{"HTTP/1.1 200 OK\r\n"
+                                            "Content-Type: text/event-stream\r\n"
+                                            "Cache-Control: no-cache\r\n"
+                                            "Connection: keep-alive\r\n\r\n"};
+constexpr std::string_view kEventStreamHeartbeatComment{": keepalive\n\n"};
+constexpr std::string_view kPrometheusContentType{"text/plain; version=0.0.4; charset=utf-8"};
+constexpr std::string_view kOkBody{"{\"status\":\"ok\"}"};
+
+constexpr std::string_view kJobsPathPrefix{"/hid/jobs/"};
+constexpr std::string_view kCalibrationPath{"/hid/calibration"};
+constexpr std::string_view kCalibrationProbePath{"/hid/calibration/probe"};
+
+using Clock = std::chrono::steady_clock;
+
+void appendJsonString(std::string& json, std::string_view value)
 {
-    const auto notSpace = [](int ch) { return !std::isspace(static_cast<unsigned char>(ch)); };
-    value.erase(value.begin(), std::find_if(value.begin(), value.end(), notSpace));
-    value.erase(std::find_if(value.rbegin(), value.rend(), notSpace).base(), value.end());
-    return value;
+    json.push_back('"');
+    for (char ch : value) {
+        switch (ch) {
+        case '"':
+            json.append("\\\"");
+            break;
+        case '\\':
+            json.append("\\\\");
+            break;
+        case '\n':
+            json.append("\\n");
+            break;
+        case '\r':
+            json.append("\\r");
+            break;
+        case '\t':
+            json.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                constexpr std::string_view kHex{"0123456789abcdef"};
+                const char escape[] = {'\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 0x0F]};
+                json.append(escape, sizeof(escape));
+            } else {
+                json.push_back(ch);
+            }
+        }
+    }
+    json.push_back('"');
+}
+
+bool parseUnsigned(std::string_view text, uint64_t& value)
+{
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+HIDEndpoint endpointForPath(std::string_view path)
+{
+    if (path == "/healthz") {
+        return HIDEndpoint::Healthz;
+    }
+    if (path == "/metrics") {
+        return HIDEndpoint::Metrics;
+    }
+    if (path == "/hid/text") {
+        return HIDEndpoint::Text;
+    }
+    if (path == "/hid/click") {
+        return HIDEndpoint::Click;
+    }
+    if (path == "/hid/move") {
+        return HIDEndpoint::Move;
+    }
+    if (path == "/hid/batch") {
+        return HIDEndpoint::Batch;
+    }
+    if (path == "/hid/stream") {
+        return HIDEndpoint::Stream;
+    }
+    if (path == "/hid/events") {
+        return HIDEndpoint::Events;
+    }
+    if (path == "/hid/release") {
+        return HIDEndpoint::Release;
+    }
+    if (path == kCalibrationPath || path == kCalibrationProbePath) {
+        return HIDEndpoint::Calibration;
+    }
+    if (path.substr(0, kJobsPathPrefix.size()) == kJobsPathPrefix) {
+        return HIDEndpoint::Jobs;
+    }
+    return HIDEndpoint::Unknown;
 }
 
-std::string statusText(int status)
+bool wantsAsync(const HttpRequestView& request)
 {
-    switch (status) {
-    case 200: return "OK";
-    case 400: return "Bad Request";
-    case 404: return "Not Found";
-    case 405: return "Method Not Allowed";
-    case 500: return "Internal Server Error";
-    default: return "Error";
+    if (const auto flag = request.queryParam("async"); flag) {
+        return *flag == "1" || *flag == "true";
     }
+    return request.headerHasToken("Prefer", "respond-async");
 }
+
 } // namespace
 
+struct HIDHttpApi::Connection {
+    uint64_t id{0};
+    int fd{-1};
+    HttpBuffer input;
+    HttpBuffer output;
+    uint32_t requestsServed{0};
+    uint64_t requestSeq{0};
+    HIDEndpoint endpoint{HIDEndpoint::Unknown};
+    Clock::time_point requestStart;
+    Clock::time_point lastActivity{Clock::now()};
+    bool busy{false};
+    bool keepAlive{true};
+    bool closeAfterWrite{false};
+    bool peerClosed{false};
+    bool websocket{false};
+    bool eventStream{false};
+    uint64_t eventFilter{0};
+};
+
+class HIDHttpApi::Reactor {
+public:
+    // Takes ownership of listenFd (the reactor's own TCP listener, or -1).
+    // unixListenFd is shared by all reactors and owned by HIDHttpApi.
+    Reactor(HIDHttpApi& api, int listenFd, int unixListenFd)
+        : api_(api)
+        , listenFd_(listenFd)
+        , unixListenFd_(unixListenFd)
+    {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd_ < 0 || wakeFd_ < 0) {
+            const auto error = std::string{std::strerror(errno)};
+            closeFds();
+            throw std::runtime_error("Failed to create HTTP reactor: " + error);
+        }
+
+        if (listenFd_ >= 0) {
+            epoll_event listenEvent{};
+            listenEvent.events = EPOLLIN;
+            listenEvent.data.u64 = kListenerToken;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent);
+        }
+        if (unixListenFd_ >= 0) {
+            epoll_event unixEvent{};
+            unixEvent.events = EPOLLIN | EPOLLEXCLUSIVE;
+            unixEvent.data.u64 = kUnixListenerToken;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, unixListenFd_, &unixEvent);
+        }
+
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.u64 = kWakeToken;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent);
+    }
+
+    ~Reactor()
+    {
+        stop();
+        closeFds();
+    }
+
+    void start()
+    {
+        running_ = true;
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    void stop()
+    {
+        running_ = false;
+        wake();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        for (auto& [id, connection] : connections_) {
+            ::close(connection->fd);
+        }
+        connections_.clear();
+    }
+
+    // Thread-safe: hands a finished response back to the reactor owning the
+    // connection. Completions for a request that was already answered (a
+    // long-poll that timed out, say) are dropped by sequence number.
+    void complete(uint64_t connectionId, uint64_t requestSeq, int statusCode, std::string body)
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex_);
+            completions_.push_back({connectionId, requestSeq, statusCode, std::move(body), false});
+        }
+        wake();
+    }
+
+    // Thread-safe: queues a text message for a WebSocket connection.
+    void pushMessage(uint64_t connectionId, std::string payload)
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex_);
+            completions_.push_back({connectionId, 0, 0, std::move(payload), true});
+        }
+        wake();
+    }
+
+    // Thread-safe: queues a pre-rendered server-sent event for every event
+    // stream on this reactor that is not filtered to a different job.
+    void broadcast(uint64_t jobId, std::shared_ptr<const std::string> event)
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex_);
+            broadcasts_.push_back({jobId, std::move(event)});
+        }
+        wake();
+    }
+
+    [[nodiscard]] bool hasEventSubscribers() const noexcept
+    {
+        return eventSubscribers_.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Parks the in-flight request until a completion arrives or the deadline
+    // passes, in which case the job's current state is returned instead.
+    void awaitJob(const Connection& connection, uint64_t jobId, Clock::time_point deadline)
+    {
+        pendingPolls_.emplace(deadline, PendingPoll{connection.id, connection.requestSeq, jobId});
+    }
+
+    // Completes the request in flight on the connection.
+    void respond(Connection& connection, int statusCode, std::string_view body, std::string_view contentType = kJsonContentType,
+                 std::string_view extraHeaders = {})
+    {
+        finishRequest(connection, statusCode);
+        if (!connection.keepAlive) {
+            connection.closeAfterWrite = true;
+        }
+
+        HttpResponseHead head;
+        head.format(statusCode, contentType, body.size(), connection.keepAlive, extraHeaders);
+        write(connection, head.view(), body);
+    }
+
+    // Answers the in-flight request with 101 and switches the connection to
+    // WebSocket framing. Any bytes already buffered after the request are
+    // parsed as frames.
+    void upgrade(Connection& connection, std::string_view response)
+    {
+        finishRequest(connection, 101);
+        connection.keepAlive = true;
+        connection.websocket = true;
+        write(connection, response, {});
+    }
+
+    // Answers the in-flight request with an open-ended text/event-stream.
+    // The connection receives broadcasts until the client goes away.
+    void startEventStream(Connection& connection, uint64_t jobFilter)
+    {
+        finishRequest(connection, 200);
+        connection.keepAlive = true;
+        connection.eventStream = true;
+        connection.eventFilter = jobFilter;
+        eventStreams_.push_back(connection.id);
+        eventSubscribers_.fetch_add(1, std::memory_order_relaxed);
+        api_.eventSubscribers_.fetch_add(1, std::memory_order_relaxed);
+        write(connection, kEventStreamHead, {});
+    }
+
+    void sendMessage(Connection& connection, WebSocketOpcode opcode, std::string_view payload)
+    {
+        const WebSocketFrameHeader header(opcode, payload.size());
+        write(connection, header.view(), payload);
+    }
+
+private:
+    struct Completion {
+        uint64_t connectionId;
+        uint64_t requestSeq;
+        int statusCode;
+        std::string body;
+        bool message;
+    };
+
+    struct Broadcast {
+        uint64_t jobId;
+        std::shared_ptr<const std::string> event;
+    };
+
+    struct PendingPoll {
+        uint64_t connectionId;
+        uint64_t requestSeq;
+        uint64_t jobId;
+    };
+
+    void finishRequest(Connection& connection, int statusCode)
+    {
+        const auto now = Clock::now();
+        hidMetrics().recordRequest(connection.endpoint, statusCode, now - connection.requestStart);
+        connection.busy = false;
+        connection.lastActivity = now;
+    }
+
+    // Writes head and body with a single gather send; only an unsent tail is
+    // copied into the connection's output buffer.
+    void write(Connection& connection, std::string_view head, std::string_view body)
+    {
+        size_t sent = 0;
+        if (connection.output.empty()) {
+            iovec parts[2] = {
+                {const_cast<char*>(head.data()), head.size()},
+                {const_cast<char*>(body.data()), body.size()},
+            };
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = body.empty() ? 1 : 2;
+            ssize_t result;
+            do {
+                result = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+            } while (result < 0 && errno == EINTR);
+            if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection.peerClosed = true;
+                connection.closeAfterWrite = true;
+                return;
+            }
+            sent = result > 0 ? static_cast<size_t>(result) : 0;
+        }
+
+        if (sent < head.size()) {
+            connection.output.append(head.substr(sent));
+            connection.output.append(body);
+        } else if (sent < head.size() + body.size()) {
+            connection.output.append(body.substr(sent - head.size()));
+        }
+    }
+
+    void run()
+    {
+        epoll_event events[kMaxEpollEvents];
+        const auto idleTimeout = std::chrono::milliseconds(api_.config_.http.keepAliveTimeoutMs);
+        const int sweepIntervalMs = std::clamp<int>(static_cast<int>(api_.config_.http.keepAliveTimeoutMs / 2), 1, kMaxSweepIntervalMs);
+        auto nextSweep = Clock::now() + std::chrono::milliseconds(sweepIntervalMs);
+
+        while (running_) {
+            const int count = ::epoll_wait(epollFd_, events, kMaxEpollEvents, nextTimeoutMs(sweepIntervalMs));
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "[hid] epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                const auto token = events[i].data.u64;
+                if (token == kListenerToken) {
+                    acceptClients(listenFd_);
+                } else if (token == kUnixListenerToken) {
+                    acceptClients(unixListenFd_);
+                } else if (token == kWakeToken) {
+                    uint64_t value = 0;
+                    (void)!::read(wakeFd_, &value, sizeof(value));
+                    drainCompletions();
+                } else {
+                    handleEvent(token, events[i].events);
+                }
+            }
+
+            const auto now = Clock::now();
+            expirePolls(now);
+            if (now >= nextSweep) {
+                closeIdleClients(now, idleTimeout);
+                nextSweep = now + std::chrono::milliseconds(sweepIntervalMs);
+            }
+        }
+    }
+
+    int nextTimeoutMs(int sweepIntervalMs) const
+    {
+        if (pendingPolls_.empty()) {
+            return sweepIntervalMs;
+        }
+        const auto untilDeadline = pendingPolls_.begin()->first - Clock::now();
+        const auto ms = std::chrono::ceil<std::chrono::milliseconds>(untilDeadline).count();
+        return static_cast<int>(std::clamp<int64_t>(ms, 0, sweepIntervalMs));
+    }
+
+    void expirePolls(Clock::time_point now)
+    {
+        while (!pendingPolls_.empty() && pendingPolls_.begin()->first <= now) {
+            const auto poll = pendingPolls_.begin()->second;
+            pendingPolls_.erase(pendingPolls_.begin());
+
+            auto it = connections_.find(poll.connectionId);
+            if (it == connections_.end() || !it->second->busy || it->second->requestSeq != poll.requestSeq) {
+                continue;
+            }
+            auto& connection = *it->second;
+            if (const auto job = api_.actions_.find(poll.jobId); job) {
+                respond(connection, 200, api_.buildJobResponse(*job));
+            } else {
+                respond(connection, 404, api_.buildJsonResponse("error", "Unknown job"));
+            }
+            processInput(connection);
+        }
+    }
+
+    void acceptClients(int listenFd)
+    {
+        while (true) {
+            const int clientFd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientFd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running_) {
+                    std::cerr << "[hid] Accept failed: " << std::strerror(errno) << std::endl;
+                }
+                return;
+            }
+
+            auto connection = std::make_unique<Connection>();
+            connection->id = nextConnectionId_++;
+            connection->fd = clientFd;
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = connection->id;
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientFd, &event) < 0) {
+                std::cerr << "[hid] Failed to register client: " << std::strerror(errno) << std::endl;
+                ::close(clientFd);
+                continue;
+            }
+            connections_.emplace(connection->id, std::move(connection));
+        }
+    }
+
+    void handleEvent(uint64_t id, uint32_t events)
+    {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) {
+            return;
+        }
+        auto& connection = *it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeClient(connection);
+            return;
+        }
+        if (events & EPOLLOUT) {
+            if (!flush(connection)) {
+                return;
+            }
+        }
+        if (events & EPOLLIN) {
+            readClient(connection);
+        }
+    }
+
+    void readClient(Connection& connection)
+    {
+        while (true) {
+            auto* buffer = connection.input.prepare(kReadChunkBytes);
+            const ssize_t received = ::recv(connection.fd, buffer, connection.input.writable(), 0);
+            if (received > 0) {
+                connection.input.commit(static_cast<size_t>(received));
+                connection.lastActivity = Clock::now();
+                if (connection.input.size() > api_.config_.http.maxRequestBytes) {
+                    break;
+                }
+                continue;
+            }
+            if (received == 0) {
+                connection.peerClosed = true;
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            closeClient(connection);
+            return;
+        }
+
+        processInput(connection);
+    }
+
+    // Dispatches buffered requests one at a time so that pipelined responses
+    // are written in request order.
+    void processInput(Connection& connection)
+    {
+        while (!connection.busy && !connection.closeAfterWrite && !connection.websocket && !connection.eventStream) {
+            size_t consumed = 0;
+            const auto status = parseHttpRequest(connection.input.readable(), request_, consumed);
+            if (status == HttpParseStatus::Complete) {
+                connection.busy = true;
+                ++connection.requestSeq;
+                connection.endpoint = endpointForPath(request_.path);
+                connection.requestStart = Clock::now();
+                connection.keepAlive = request_.wantsKeepAlive() && ++connection.requestsServed < api_.config_.http.maxRequestsPerConnection;
+                api_.handleRequest(*this, connection, request_);
+                connection.input.consume(consumed);
+                continue;
+            }
+            connection.endpoint = HIDEndpoint::Unknown;
+            connection.requestStart = Clock::now();
+            if (status == HttpParseStatus::Invalid) {
+                connection.keepAlive = false;
+                respond(connection, 400, api_.buildJsonResponse("error", "Malformed HTTP request"));
+                break;
+            }
+            if (connection.input.size() > api_.config_.http.maxRequestBytes) {
+                connection.keepAlive = false;
+                respond(connection, 413, api_.buildJsonResponse("error", "Request too large"));
+            }
+            break;
+        }
+        if (connection.websocket) {
+            processFrames(connection);
+        } else if (connection.eventStream) {
+            connection.input.clear();
+        }
+
+        if ((!connection.output.empty() || connection.closeAfterWrite) && !flush(connection)) {
+            return;
+        }
+        if (connection.peerClosed && !connection.busy && connection.output.empty()) {
+            closeClient(connection);
+            return;
+        }
+        updateInterest(connection);
+    }
+
+    void processFrames(Connection& connection)
+    {
+        while (!connection.closeAfterWrite) {
+            WebSocketFrame frame;
+            size_t consumed = 0;
+            const auto status = parseWebSocketFrame(connection.input.readable(), frame, consumed);
+            if (status == WebSocketParseStatus::Invalid) {
+                closeWebSocket(connection, 1002, "Protocol error");
+                return;
+            }
+            if (status == WebSocketParseStatus::Incomplete) {
+                if (connection.input.size() > api_.config_.http.maxRequestBytes) {
+                    closeWebSocket(connection, 1009, "Message too large");
+                }
+                return;
+            }
+
+            unmaskWebSocketPayload(frame, payload_);
+            connection.input.consume(consumed);
+            switch (frame.opcode) {
+            case WebSocketOpcode::Text:
+                if (!frame.fin) {
+                    closeWebSocket(connection, 1003, "Fragmented messages are not supported");
+                    return;
+                }
+                api_.handleStreamMessage(*this, connection, payload_);
+                break;
+            case WebSocketOpcode::Ping:
+                sendMessage(connection, WebSocketOpcode::Pong, payload_);
+                break;
+            case WebSocketOpcode::Pong:
+                break;
+            case WebSocketOpcode::Close:
+                sendMessage(connection, WebSocketOpcode::Close, std::string_view{payload_}.substr(0, 2));
+                connection.closeAfterWrite = true;
+                return;
+            case WebSocketOpcode::Binary:
+                closeWebSocket(connection, 1003, "Binary messages are not supported");
+                return;
+            case WebSocketOpcode::Continuation:
+                closeWebSocket(connection, 1002, "Unexpected continuation frame");
+                return;
+            }
+        }
+    }
+
+    void closeWebSocket(Connection& connection, uint16_t code, std::string_view reason)
+    {
+        std::string payload;
+        payload.push_back(static_cast<char>(code >> 8));
+        payload.push_back(static_cast<char>(code & 0xFF));
+        payload.append(reason);
+        sendMessage(connection, WebSocketOpcode::Close, payload);
+        connection.closeAfterWrite = true;
+    }
+
+    // Returns false when the connection was closed.
+    bool flush(Connection& connection)
+    {
+        while (!connection.output.empty()) {
+            const auto pending = connection.output.readable();
+            const ssize_t sent = ::send(connection.fd, pending.data(), pending.size(), MSG_NOSIGNAL);
+            if (sent > 0) {
+                connection.output.consume(static_cast<size_t>(sent));
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                updateInterest(connection);
+                return true;
+            }
+            closeClient(connection);
+            return false;
+        }
+
+        if (connection.closeAfterWrite) {
+            closeClient(connection);
+            return false;
+        }
+        updateInterest(connection);
+        return true;
+    }
+
+    void updateInterest(Connection& connection)
+    {
+        epoll_event event{};
+        event.data.u64 = connection.id;
+        if (!connection.closeAfterWrite && !connection.peerClosed && connection.input.size() <= api_.config_.http.maxRequestBytes) {
+            event.events |= EPOLLIN;
+        }
+        if (!connection.output.empty()) {
+            event.events |= EPOLLOUT;
+        }
+        ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd, &event);
+    }
+
+    void closeClient(Connection& connection)
+    {
+        const auto id = connection.id;
+        if (connection.eventStream) {
+            eventStreams_.erase(std::find(eventStreams_.begin(), eventStreams_.end(), id));
+            eventSubscribers_.fetch_sub(1, std::memory_order_relaxed);
+            api_.eventSubscribers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::shutdown(connection.fd, SHUT_RDWR);
+        ::close(connection.fd);
+        connections_.erase(id);
+    }
+
+    void drainCompletions()
+    {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex_);
+            drained_.swap(completions_);
+            drainedBroadcasts_.swap(broadcasts_);
+        }
+        for (const auto& broadcast : drainedBroadcasts_) {
+            deliverEvent(broadcast);
+        }
+        drainedBroadcasts_.clear();
+
+        for (auto& completion : drained_) {
+            auto it = connections_.find(completion.connectionId);
+            if (it == connections_.end()) {
+                continue;
+            }
+            auto& connection = *it->second;
+            if (completion.message) {
+                if (connection.websocket && !connection.closeAfterWrite) {
+                    sendMessage(connection, WebSocketOpcode::Text, completion.body);
+                    if (!connection.output.empty() || connection.closeAfterWrite) {
+                        flush(connection);
+                    }
+                }
+                continue;
+            }
+            if (!connection.busy || connection.requestSeq != completion.requestSeq) {
+                continue;
+            }
+            respond(connection, completion.statusCode, completion.body);
+            processInput(connection);
+        }
+        drained_.clear();
+    }
+
+    // Slow readers are dropped once their backlog passes kMaxEventBacklogBytes
+    // rather than buffering events without bound.
+    void deliverEvent(const Broadcast& broadcast)
+    {
+        std::vector<uint64_t> lagging;
+        for (const auto id : eventStreams_) {
+            auto& connection = *connections_.at(id);
+            if (connection.eventFilter != 0 && connection.eventFilter != broadcast.jobId) {
+                continue;
+            }
+            if (connection.output.size() > kMaxEventBacklogBytes) {
+                lagging.push_back(id);
+                continue;
+            }
+            connection.lastActivity = Clock::now();
+            write(connection, *broadcast.event, {});
+            if (!connection.output.empty()) {
+                updateInterest(connection);
+            }
+        }
+        for (const auto id : lagging) {
+            closeClient(*connections_.at(id));
+        }
+    }
+
+    void closeIdleClients(Clock::time_point now, std::chrono::milliseconds idleTimeout)
+    {
+        std::vector<uint64_t> idle;
+        for (const auto& [id, connection] : connections_) {
+            if (connection->eventStream) {
+                if (now - connection->lastActivity >= kEventStreamHeartbeat && connection->output.empty()) {
+                    connection->lastActivity = now;
+                    write(*connection, kEventStreamHeartbeatComment, {});
+                }
+                continue;
+            }
+            const auto timeout = connection->websocket ? std::chrono::duration_cast<std::chrono::milliseconds>(kWebSocketIdleTimeout) : idleTimeout;
+            if (!connection->busy && connection->output.empty() && now - connection->lastActivity >= timeout) {
+                idle.push_back(id);
+            }
+        }
+        for (const auto id : idle) {
+            closeClient(*connections_.at(id));
+        }
+    }
+
+    void wake()
+    {
+        if (wakeFd_ >= 0) {
+            const uint64_t value = 1;
+            (void)!::write(wakeFd_, &value, sizeof(value));
+        }
+    }
+
+    void closeFds()
+    {
+        if (epollFd_ >= 0) {
+            ::close(epollFd_);
+            epollFd_ = -1;
+        }
+        if (wakeFd_ >= 0) {
+            ::close(wakeFd_);
+            wakeFd_ = -1;
+        }
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+        }
+    }
+
+    HIDHttpApi& api_;
+    int listenFd_{-1};
+    int unixListenFd_{-1};
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections_;
+    uint64_t nextConnectionId_{kFirstConnectionId};
+    HttpRequestView request_;
+    std::string payload_;
+    std::multimap<Clock::time_point, PendingPoll> pendingPolls_;
+
+    std::mutex completionMutex_;
+    std::vector<Completion> completions_;
+    std::vector<Completion> drained_;
+    std::vector<Broadcast> broadcasts_;
+    std::vector<Broadcast> drainedBroadcasts_;
+
+    std::vector<uint64_t> eventStreams_;
+    std::atomic<size_t> eventSubscribers_{0};
+};
+
 HIDHttpApi::HIDHttpApi(BluetoothHIDServer& hid, const HIDConfig& config)
     : hid_(hid)
     , config_(config)
+    , actions_(config_.jobs)
 {
 }
 
@@ -57,8 +837,45 @@ void HIDHttpApi::start()
     if (running_) {
         return;
     }
+
+    const auto reactorCount = std::max<uint32_t>(config_.http.reactorThreads, 1);
+    const bool reusePort = reactorCount > 1;
+    try {
+        if (!config_.http.unixSocket.empty()) {
+            unixListenFd_ = openUnixListener();
+        }
+        for (uint32_t i = 0; i < reactorCount; ++i) {
+            const int listenFd = config_.http.tcpEnabled ? openListener(reusePort) : -1;
+            reactors_.push_back(std::make_unique<Reactor>(*this, listenFd, unixListenFd_));
+        }
+    } catch (...) {
+        reactors_.clear();
+        closeUnixListener();
+        throw;
+    }
+
+    actions_.setObserver([this](HIDJobEvent event, const HIDJobSnapshot& job) { publishJobEvent(event, job); }, &eventSubscribers_);
+    actions_.setInterruptHook([this]() {
+        if (config_.keyboard.enabled) {
+            hid_.setKey(0, 0);
+        }
+    });
+    hid_.setReportBoundaryHook([this]() { actions_.checkpoint(); });
+    loadStartupCalibration();
+    actions_.start();
     running_ = true;
-    serverThread_ = std::thread([this]() { serverLoop(); });
+    for (auto& reactor : reactors_) {
+        reactor->start();
+    }
+
+    std::cout << "[hid] HTTP API listening on ";
+    if (config_.http.tcpEnabled) {
+        std::cout << config_.http.bindAddress << ":" << config_.http.port;
+    }
+    if (unixListenFd_ >= 0) {
+        std::cout << (config_.http.tcpEnabled ? " and " : "") << "unix:" << config_.http.unixSocket;
+    }
+    std::cout << " (" << reactorCount << " reactor" << (reactorCount == 1 ? "" : "s") << ")" << std::endl;
 }
 
 void HIDHttpApi::stop()
@@ -68,230 +885,676 @@ void HIDHttpApi::stop()
     }
     running_ = false;
 
-    if (serverFd_ >= 0) {
-        ::shutdown(serverFd_, SHUT_RDWR);
-        ::close(serverFd_);
-        serverFd_ = -1;
+    for (auto& reactor : reactors_) {
+        reactor->stop();
+    }
+    actions_.stop();
+    reactors_.clear();
+    closeUnixListener();
+}
+
+int HIDHttpApi::openListener(bool reusePort) const
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.http.port);
+    if (config_.http.bindAddress == "0.0.0.0" || config_.http.bindAddress == "*") {
+        addr.sin_addr.s_addr = INADDR_ANY;
+    } else if (::inet_pton(AF_INET, config_.http.bindAddress.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid bind address: " + config_.http.bindAddress);
+    }
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string{"Failed to create server socket: "} + std::strerror(errno));
     }
 
-    if (serverThread_.joinable()) {
-        serverThread_.join();
+    int opt = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (reusePort && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("SO_REUSEPORT failed: " + error);
     }
+
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("Bind failed: " + error);
+    }
+
+    if (::listen(fd, static_cast<int>(config_.http.backlog)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("Listen failed: " + error);
+    }
+
+    return fd;
 }
 
-void HIDHttpApi::serverLoop()
+int HIDHttpApi::openUnixListener() const
 {
-    serverFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
-    if (serverFd_ < 0) {
-        std::cerr << "[hid] Failed to create server socket: " << std::strerror(errno) << std::endl;
-        running_ = false;
+    const auto& path = config_.http.unixSocket;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // Only a stale socket left by a previous run is removed; any other file
+    // at the path is an operator error and makes bind fail below.
+    struct stat existing{};
+    if (::lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(path.c_str());
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string{"Failed to create unix socket: "} + std::strerror(errno));
+    }
+
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("Bind failed for " + path + ": " + error);
+    }
+
+    if (::chmod(path.c_str(), static_cast<mode_t>(config_.http.unixSocketMode)) < 0
+        || ::listen(fd, static_cast<int>(config_.http.backlog)) < 0) {
+        const auto error = std::string{std::strerror(errno)};
+        ::close(fd);
+        ::unlink(path.c_str());
+        throw std::runtime_error("Failed to listen on " + path + ": " + error);
+    }
+
+    return fd;
+}
+
+void HIDHttpApi::closeUnixListener()
+{
+    if (unixListenFd_ < 0) {
         return;
     }
+    ::close(unixListenFd_);
+    unixListenFd_ = -1;
+    ::unlink(config_.http.unixSocket.c_str());
+}
 
-    int opt = 1;
-    ::setsockopt(serverFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+void HIDHttpApi::handleRequest(Reactor& reactor, Connection& connection, const HttpRequestView& request)
+{
+    const auto method = request.method;
+    const auto target = request.path;
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(config_.http.port);
-    if (config_.http.bindAddress == "0.0.0.0" || config_.http.bindAddress == "*") {
-        addr.sin_addr.s_addr = INADDR_ANY;
-    } else {
-        if (::inet_pton(AF_INET, config_.http.bindAddress.c_str(), &addr.sin_addr) != 1) {
-            std::cerr << "[hid] Invalid bind address: " << config_.http.bindAddress << std::endl;
-            running_ = false;
-            ::close(serverFd_);
-            serverFd_ = -1;
+    if (method == "GET" && target == "/healthz") {
+        const auto backlog = std::chrono::ceil<std::chrono::milliseconds>(actions_.backlog());
+        std::string body;
+        body.append("{\"status\":\"ok\",\"hid_running\":").append(hid_.isRunning() ? "true" : "false");
+        body.append(",\"queue_depth\":").append(std::to_string(actions_.depth()));
+        body.append(",\"queue_delay_ms\":").append(std::to_string(backlog.count()));
+        const auto pacing = hid_.pacingState();
+        body.append(",\"pacing\":{\"adaptive\":").append(pacing.adaptive ? "true" : "false");
+        body.append(",\"connection_interval_us\":");
+        body.append(pacing.connectionInterval.count() != 0 ? std::to_string(pacing.connectionInterval.count()) : "null");
+        body.append(",\"keypress_interval_us\":").append(std::to_string(pacing.keypressInterval.count()));
+        body.append(",\"pointer_interval_us\":").append(std::to_string(pacing.pointerInterval.count()));
+        body.append("}}");
+        reactor.respond(connection, 200, body);
+        return;
+    }
+
+    if (method == "GET" && target == "/metrics") {
+        std::string body;
+        body.reserve(32768);
+        hidMetrics().render(body);
+        body.append("# HELP jadeai_hid_action_queue_depth Actions waiting for the HID executor.\n"
+                    "# TYPE jadeai_hid_action_queue_depth gauge\n"
+                    "jadeai_hid_action_queue_depth ");
+        body.append(std::to_string(actions_.depth())).append("\n");
+        body.append("# HELP jadeai_hid_action_queue_delay_seconds Estimated time to drain the action queue.\n"
+                    "# TYPE jadeai_hid_action_queue_delay_seconds gauge\n"
+                    "jadeai_hid_action_queue_delay_seconds ");
+        body.append(std::to_string(std::chrono::duration<double>(actions_.backlog()).count())).append("\n");
+        const auto pacing = hid_.pacingState();
+        body.append("# HELP jadeai_hid_connection_interval_seconds Negotiated BLE connection interval, 0 until observed.\n"
+                    "# TYPE jadeai_hid_connection_interval_seconds gauge\n"
+                    "jadeai_hid_connection_interval_seconds ");
+        body.append(std::to_string(std::chrono::duration<double>(pacing.connectionInterval).count())).append("\n");
+        body.append("# HELP jadeai_hid_report_interval_seconds Interval currently used to pace reports.\n"
+                    "# TYPE jadeai_hid_report_interval_seconds gauge\n"
+                    "jadeai_hid_report_interval_seconds{kind=\"keypress\"} ");
+        body.append(std::to_string(std::chrono::duration<double>(pacing.keypressInterval).count())).append("\n");
+        body.append("jadeai_hid_report_interval_seconds{kind=\"pointer\"} ");
+        body.append(std::to_string(std::chrono::duration<double>(pacing.pointerInterval).count())).append("\n");
+        reactor.respond(connection, 200, body, kPrometheusContentType);
+        return;
+    }
+
+    if (method == "GET" && target == "/hid/events") {
+        uint64_t jobFilter = 0;
+        if (const auto job = request.queryParam("job_id"); job && !parseUnsigned(*job, jobFilter)) {
+            reactor.respond(connection, 400, buildJsonResponse("error", "job_id must be a positive integer"));
             return;
         }
+        reactor.startEventStream(connection, jobFilter);
+        return;
     }
 
-    if (::bind(serverFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-        std::cerr << "[hid] Bind failed: " << std::strerror(errno) << std::endl;
-        running_ = false;
-        ::close(serverFd_);
-        serverFd_ = -1;
+    if (method == "GET" && target == "/hid/stream") {
+        const auto key = request.header("Sec-WebSocket-Key");
+        if (!key || key->empty() || !request.headerHasToken("Upgrade", "websocket") || !request.headerHasToken("Connection", "upgrade")
+            || request.header("Sec-WebSocket-Version") != "13") {
+            reactor.respond(connection, 400, buildJsonResponse("error", "Expected a WebSocket upgrade (version 13)"));
+            return;
+        }
+        reactor.upgrade(connection, webSocketHandshakeResponse(*key));
         return;
     }
 
-    if (::listen(serverFd_, 8) < 0) {
-        std::cerr << "[hid] Listen failed: " << std::strerror(errno) << std::endl;
-        running_ = false;
-        ::close(serverFd_);
-        serverFd_ = -1;
+    if (method == "GET" && target.substr(0, kJobsPathPrefix.size()) == kJobsPathPrefix) {
+        handleJobQuery(reactor, connection, request);
         return;
     }
 
-    std::cout << "[hid] HTTP API listening on " << config_.http.bindAddress << ":" << config_.http.port << std::endl;
+    if (method == "DELETE" && target.substr(0, kJobsPathPrefix.size()) == kJobsPathPrefix) {
+        handleJobCancel(reactor, connection, request);
+        return;
+    }
 
-    while (running_) {
-        sockaddr_in client{};
-        socklen_t len = sizeof(client);
-        const int clientFd = ::accept(serverFd_, reinterpret_cast<sockaddr*>(&client), &len);
-        if (clientFd < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            if (running_) {
-                std::cerr << "[hid] Accept failed: " << std::strerror(errno) << std::endl;
+    if (target == kCalibrationPath) {
+        handleCalibration(reactor, connection, request);
+        return;
+    }
+
+    std::string_view kind;
+    HIDActionQueue::Task task;
+    std::chrono::microseconds cost{0};
+    auto priority = HIDPriority::Normal;
+    std::optional<HIDPointerTarget> retarget;
+    try {
+        if (const auto lane = request.queryParam("priority"); lane) {
+            priority = priorityFromString(*lane);
+        }
+        if (method == "POST" && target == kCalibrationProbePath) {
+            const auto command = decodeProbeCommand(request.body);
+            kind = "probe";
+            cost = hid_.pacingState().pointerInterval * command.reports;
+            task = [this, command](const HIDProgressCallback& progress) {
+                const auto counts = hid_.probePointer(command.step, command.reports, progress);
+                return "{\"status\":\"ok\",\"step\":" + std::to_string(command.step) + ",\"reports\":" + std::to_string(command.reports)
+                    + ",\"counts\":" + std::to_string(counts) + "}";
+            };
+        } else if (method == "POST" && target == "/hid/release") {
+            kind = "release";
+            priority = HIDPriority::High;
+            task = [this](const HIDProgressCallback&) {
+                hid_.releaseAll();
+                return std::string{kOkBody};
+            };
+        } else if (method == "POST" && target == "/hid/text") {
+            auto command = decodeTextCommand(request.body);
+            kind = "text";
+            cost = hid_.estimateDuration({HIDAction{HIDActionType::Text, 0, 0, MouseButton::Left, command.text, 0}});
+            task = [this, text = std::move(command.text)](const HIDProgressCallback& progress) {
+                hid_.sendText(text, progress);
+                return std::string{kOkBody};
+            };
+        } else if (method == "POST" && target == "/hid/click") {
+            const auto command = decodeClickCommand(request.body);
+            kind = "click";
+            cost = hid_.estimateDuration({HIDAction{HIDActionType::Click, command.x, command.y, command.button, {}, 0}});
+            task = [this, command](const HIDProgressCallback& progress) {
+                hid_.click(command.x, command.y, command.button, progress);
+                return std::string{kOkBody};
+            };
+        } else if (method == "POST" && target == "/hid/move") {
+            const auto command = decodeMoveCommand(request.body);
+            kind = "move";
+            cost = hid_.estimateDuration({HIDAction{HIDActionType::Move, command.x, command.y, MouseButton::Left, {}, 0}});
+            retarget = hid_.reservePointerTarget(command.x, command.y);
+            task = [this, target = *retarget](const HIDProgressCallback& progress) {
+                hid_.movePointer(target, progress);
+                return std::string{kOkBody};
+            };
+        } else if (method == "POST" && target == "/hid/batch") {
+            auto actions = decodeBatchCommand(request.body);
+            kind = "batch";
+            cost = hid_.estimateDuration(actions);
+            task = [this, actions = std::move(actions)](const HIDProgressCallback& progress) {
+                return buildBatchResponse(actions, hid_.executeBatch(actions, progress));
+            };
+        } else {
+            reactor.respond(connection, 404, buildJsonResponse("error", "Unknown endpoint"));
+            return;
+        }
+    } catch (const std::exception& ex) {
+        reactor.respond(connection, 400, buildJsonResponse("error", ex.what()));
+        return;
+    }
+
+    try {
+        if (wantsAsync(request)) {
+            const auto jobId = actions_.submit(std::string{kind}, priority, cost, std::move(task));
+            if (retarget) {
+                hid_.retargetPointer(*retarget);
             }
-            break;
+            respondAccepted(reactor, connection, request, jobId);
+            return;
         }
 
-        handleClient(clientFd);
+        actions_.submit(std::string{kind}, priority, cost, std::move(task),
+                        [this, &reactor, id = connection.id, seq = connection.requestSeq](const HIDJobSnapshot& job) {
+                            if (job.state == HIDJobState::Succeeded) {
+                                reactor.complete(id, seq, 200, job.result);
+                            } else if (job.state == HIDJobState::Cancelled) {
+                                reactor.complete(id, seq, 409, buildJsonResponse("error", job.error));
+                            } else {
+                                reactor.complete(id, seq, 400, buildJsonResponse("error", job.error));
+                            }
+                        });
+        if (retarget) {
+            hid_.retargetPointer(*retarget);
+        }
+    } catch (const HIDQueueFullError& ex) {
+        respondQueueFull(reactor, connection, ex);
     }
+}
 
-    if (serverFd_ >= 0) {
-        ::close(serverFd_);
-        serverFd_ = -1;
+void HIDHttpApi::handleCalibration(Reactor& reactor, Connection& connection, const HttpRequestView& request)
+{
+    if (request.method == "GET") {
+        const auto calibration = hid_.pointerCalibration();
+        if (!calibration) {
+            reactor.respond(connection, 404, buildJsonResponse("error", "No pointer calibration is active"));
+            return;
+        }
+        reactor.respond(connection, 200, buildCalibrationResponse(*calibration));
+        return;
+    }
+    if (request.method == "DELETE") {
+        hid_.setPointerCalibration(nullptr);
+        reactor.respond(connection, 200, std::string{kOkBody});
+        return;
+    }
+    if (request.method != "PUT") {
+        reactor.respond(connection, 405, buildJsonResponse("error", "Use GET, PUT or DELETE"));
+        return;
     }
 
-    running_ = false;
+    CalibrationCommand command;
+    std::shared_ptr<const HIDPointerCalibration> calibration;
+    try {
+        command = decodeCalibrationCommand(request.body);
+        if (command.samples) {
+            calibration = std::make_shared<HIDPointerCalibration>(command.host, std::move(*command.samples));
+        }
+    } catch (const std::exception& ex) {
+        reactor.respond(connection, 400, buildJsonResponse("error", ex.what()));
+        return;
+    }
+
+    // Profile files are read and written on the executor so that disk I/O
+    // never stalls the other connections on this reactor.
+    auto status = std::make_shared<int>(200);
+    try {
+        actions_.post(
+            std::chrono::microseconds{0},
+            [this, status, host = std::move(command.host), calibration](const HIDProgressCallback&) {
+                return storeCalibration(host, calibration, *status);
+            },
+            [this, &reactor, id = connection.id, seq = connection.requestSeq, status](const HIDJobSnapshot& job) {
+                if (job.state == HIDJobState::Succeeded) {
+                    reactor.complete(id, seq, *status, job.result);
+                } else {
+                    reactor.complete(id, seq, 500, buildJsonResponse("error", job.error));
+                }
+            });
+    } catch (const HIDQueueFullError& ex) {
+        respondQueueFull(reactor, connection, ex);
+    }
 }
 
-void HIDHttpApi::handleClient(int clientFd)
+// Loads the host's stored profile when no samples were given, otherwise
+// stores the new one, then activates it. Runs on the executor.
+std::string HIDHttpApi::storeCalibration(const std::string& host, std::shared_ptr<const HIDPointerCalibration> calibration, int& status)
 {
-    std::string data;
-    data.reserve(1024);
-
-    char buffer[1024];
-    ssize_t received = 0;
-    while ((received = ::recv(clientFd, buffer, sizeof(buffer), 0)) > 0) {
-        data.append(buffer, buffer + received);
-        auto headerEnd = data.find("\r\n\r\n");
-        if (headerEnd != std::string::npos) {
-            // We have headers; ensure full body is read
-            std::istringstream headerStream(data.substr(0, headerEnd));
-            std::string requestLine;
-            std::getline(headerStream, requestLine);
-            if (!requestLine.empty() && requestLine.back() == '\r') {
-                requestLine.pop_back();
-            }
-
-            std::map<std::string, std::string> headers;
-            std::string line;
-            size_t contentLength = 0;
-            while (std::getline(headerStream, line)) {
-                if (!line.empty() && line.back() == '\r') {
-                    line.pop_back();
-                }
-                const auto colon = line.find(':');
-                if (colon != std::string::npos) {
-                    auto key = trim(line.substr(0, colon));
-                    auto value = trim(line.substr(colon + 1));
-                    headers[key] = value;
-                    if (strcasecmp(key.c_str(), "Content-Length") == 0) {
-                        try {
-                            contentLength = static_cast<size_t>(std::stoul(value));
-                        } catch (const std::exception&) {
-                            contentLength = 0;
-                        }
-                    }
-                }
-            }
+    if (!calibration) {
+        const auto path = calibrationPath(host);
+        if (path.empty() || !std::filesystem::exists(path)) {
+            status = 404;
+            return buildJsonResponse("error", "No stored calibration for host '" + host + "'");
+        }
+        try {
+            calibration = std::make_shared<HIDPointerCalibration>(HIDPointerCalibration::load(path));
+        } catch (const std::exception& ex) {
+            status = 400;
+            return buildJsonResponse("error", ex.what());
+        }
+    } else if (const auto path = calibrationPath(calibration->host()); !path.empty()) {
+        try {
+            calibration->save(path);
+        } catch (const std::exception& ex) {
+            status = 500;
+            return buildJsonResponse("error", ex.what());
+        }
+    }
+    hid_.setPointerCalibration(calibration);
+    return buildCalibrationResponse(*calibration);
+}
+
+void HIDHttpApi::respondQueueFull(Reactor& reactor, Connection& connection, const HIDQueueFullError& ex)
+{
+    // Retry-After only has whole-second resolution; the body carries the
+    // millisecond estimate for clients that can use it.
+    const auto retryAfter = ex.retryAfter();
+    const auto seconds = std::chrono::ceil<std::chrono::seconds>(retryAfter);
+    std::string body;
+    body.append("{\"status\":\"error\",\"detail\":");
+    appendJsonString(body, ex.what());
+    body.append(",\"retry_after_ms\":").append(std::to_string(retryAfter.count())).push_back('}');
+    const auto headers = "Retry-After: " + std::to_string(seconds.count()) + "\r\n";
+    reactor.respond(connection, 429, body, kJsonContentType, headers);
+}
+
+std::string HIDHttpApi::calibrationPath(const std::string& host) const
+{
+    if (!isValidCalibrationHost(host)) {
+        throw std::invalid_argument("host must be 1-64 characters of [A-Za-z0-9._-]");
+    }
+    if (config_.calibration.directory.empty()) {
+        return {};
+    }
+    return (std::filesystem::path(config_.calibration.directory) / (host + ".yml")).string();
+}
+
+void HIDHttpApi::loadStartupCalibration()
+{
+    if (config_.calibration.host.empty()) {
+        return;
+    }
+    std::string path;
+    try {
+        path = calibrationPath(config_.calibration.host);
+        if (path.empty() || !std::filesystem::exists(path)) {
+            return;
+        }
+        hid_.setPointerCalibration(std::make_shared<HIDPointerCalibration>(HIDPointerCalibration::load(path)));
+    } catch (const std::exception& ex) {
+        std::cerr << "[hid] Ignoring calibration profile for host " << config_.calibration.host << ": " << ex.what() << std::endl;
+    }
+}
+
+std::string HIDHttpApi::buildCalibrationResponse(const HIDPointerCalibration& calibration) const
+{
+    std::string json;
+    json.append("{\"status\":\"ok\",\"host\":");
+    appendJsonString(json, calibration.host());
+    json.append(",\"samples\":[");
+    for (size_t i = 0; i < calibration.samples().size(); ++i) {
+        const auto& sample = calibration.samples()[i];
+        if (i != 0) {
+            json.push_back(',');
+        }
+        json.append("{\"step\":").append(std::to_string(sample.step));
+        json.append(",\"reports\":").append(std::to_string(sample.reports));
+        json.append(",\"pixels\":").append(std::to_string(sample.pixels)).push_back('}');
+    }
+    json.append("]}");
+    return json;
+}
+
+void HIDHttpApi::respondAccepted(Reactor& reactor, Connection& connection, const HttpRequestView& request, uint64_t jobId)
+{
+    const auto location = std::string{kJobsPathPrefix} + std::to_string(jobId);
+    std::string body;
+    body.append("{\"status\":\"accepted\",\"job_id\":").append(std::to_string(jobId));
+    body.append(",\"location\":\"").append(location).append("\"}");
+    std::string headers;
+    headers.append("Location: ").append(location).append("\r\n");
+    if (request.headerHasToken("Prefer", "respond-async")) {
+        headers.append("Preference-Applied: respond-async\r\n");
+    }
+    reactor.respond(connection, 202, body, kJsonContentType, headers);
+}
+
+void HIDHttpApi::handleJobQuery(Reactor& reactor, Connection& connection, const HttpRequestView& request)
+{
+    uint64_t jobId = 0;
+    if (!parseUnsigned(request.path.substr(kJobsPathPrefix.size()), jobId)) {
+        reactor.respond(connection, 404, buildJsonResponse("error", "Unknown job"));
+        return;
+    }
+
+    uint64_t waitMs = 0;
+    if (const auto wait = request.queryParam("wait_ms"); wait && !parseUnsigned(*wait, waitMs)) {
+        reactor.respond(connection, 400, buildJsonResponse("error", "wait_ms must be a non-negative integer"));
+        return;
+    }
+    waitMs = std::min<uint64_t>(waitMs, config_.jobs.maxWaitMs);
+
+    const auto job = actions_.find(jobId);
+    if (!job) {
+        reactor.respond(connection, 404, buildJsonResponse("error", "Unknown job"));
+        return;
+    }
+    if (job->finished() || waitMs == 0) {
+        reactor.respond(connection, 200, buildJobResponse(*job));
+        return;
+    }
+
+    reactor.awaitJob(connection, jobId, Clock::now() + std::chrono::milliseconds(waitMs));
+    actions_.watch(jobId, [this, &reactor, id = connection.id, seq = connection.requestSeq](const HIDJobSnapshot& finished) {
+        reactor.complete(id, seq, 200, buildJobResponse(finished));
+    });
+}
+
+// Answers once the job has actually stopped, so a 200 means no further
+// reports will be sent for it.
+void HIDHttpApi::handleJobCancel(Reactor& reactor, Connection& connection, const HttpRequestView& request)
+{
+    uint64_t jobId = 0;
+    if (!parseUnsigned(request.path.substr(kJobsPathPrefix.size()), jobId)) {
+        reactor.respond(connection, 404, buildJsonResponse("error", "Unknown job"));
+        return;
+    }
+    if (!actions_.cancel(jobId)) {
+        if (const auto job = actions_.find(jobId); job) {
+            reactor.respond(connection, 409, buildJobResponse(*job));
+        } else {
+            reactor.respond(connection, 404, buildJsonResponse("error", "Unknown job"));
+        }
+        return;
+    }
+
+    reactor.awaitJob(connection, jobId, Clock::now() + std::chrono::milliseconds(config_.jobs.maxWaitMs));
+    actions_.watch(jobId, [this, &reactor, id = connection.id, seq = connection.requestSeq](const HIDJobSnapshot& finished) {
+        reactor.complete(id, seq, 200, buildJobResponse(finished));
+    });
+}
+
+void HIDHttpApi::handleStreamMessage(Reactor& reactor, Connection& connection, std::string_view payload)
+{
+    StreamMessage message;
+    try {
+        message = decodeStreamMessage(payload);
+    } catch (const std::exception& ex) {
+        const auto error = buildStreamError({}, ex.what());
+        reactor.sendMessage(connection, WebSocketOpcode::Text, error);
+        return;
+    }
+
+    std::chrono::microseconds cost{0};
+    if (message.type == StreamMessageType::Move) {
+        cost = hid_.estimateDuration({HIDAction{HIDActionType::Move, message.x, message.y, MouseButton::Left, {}, 0}});
+    }
 
-            std::string body = data.substr(headerEnd + 4);
-            while (body.size() < contentLength) {
-                received = ::recv(clientFd, buffer, sizeof(buffer), 0);
-                if (received <= 0) {
+    try {
+        actions_.post(
+            cost,
+            [this, message](const HIDProgressCallback&) {
+                switch (message.type) {
+                case StreamMessageType::Move:
+                    hid_.movePointer(message.x, message.y);
+                    break;
+                case StreamMessageType::Button:
+                    hid_.setButton(message.button, message.pressed);
+                    break;
+                case StreamMessageType::Wheel:
+                    hid_.scroll(message.delta);
                     break;
                 }
-                body.append(buffer, buffer + received);
-            }
-
-            std::istringstream requestLineStream(requestLine);
-            std::string method;
-            std::string target;
-            std::string version;
-            requestLineStream >> method >> target >> version;
-
-            if (method == "GET" && target == "/healthz") {
-                std::ostringstream bodyStream;
-                bodyStream << "{\"status\":\"ok\",\"hid_running\":" << (hid_.isRunning() ? "true" : "false") << "}";
-                sendResponse(clientFd, 200, statusText(200), bodyStream.str());
-            } else if (method == "POST" && target == "/hid/text") {
-                try {
-                    const auto payload = YAML::Load(body);
-                    const auto text = payload["text"].as<std::string>();
-                    hid_.sendText(text);
-                    sendResponse(clientFd, 200, statusText(200), buildJsonResponse("ok"));
-                } catch (const std::exception& ex) {
-                    sendResponse(clientFd, 400, statusText(400), buildJsonResponse("error", ex.what()));
-                }
-            } else if (method == "POST" && target == "/hid/click") {
-                try {
-                    const auto payload = YAML::Load(body);
-                    const int x = payload["x"].as<int>();
-                    const int y = payload["y"].as<int>();
-                    const auto buttonName = payload["button"].IsDefined() ? payload["button"].as<std::string>() : std::string{"left"};
-                    hid_.click(x, y, mouseButtonFromString(buttonName));
-                    sendResponse(clientFd, 200, statusText(200), buildJsonResponse("ok"));
-                } catch (const std::exception& ex) {
-                    sendResponse(clientFd, 400, statusText(400), buildJsonResponse("error", ex.what()));
-                }
-            } else if (method == "POST" && target == "/hid/move") {
-                try {
-                    const auto payload = YAML::Load(body);
-                    const int x = payload["x"].as<int>();
-                    const int y = payload["y"].as<int>();
-                    hid_.movePointer(x, y);
-                    sendResponse(clientFd, 200, statusText(200), buildJsonResponse("ok"));
-                } catch (const std::exception& ex) {
-                    sendResponse(clientFd, 400, statusText(400), buildJsonResponse("error", ex.what()));
-                }
-            } else {
-                sendResponse(clientFd, 404, statusText(404), buildJsonResponse("error", "Unknown endpoint"));
-            }
-            break;
+                return buildStreamAck(message.seq);
+            },
+            [this, &reactor, id = connection.id, seq = message.seq](const HIDJobSnapshot& job) {
+                reactor.pushMessage(id, job.state == HIDJobState::Succeeded ? job.result : buildStreamError(seq, job.error));
+            });
+    } catch (const HIDQueueFullError& ex) {
+        reactor.sendMessage(connection, WebSocketOpcode::Text, buildStreamError(message.seq, ex.what()));
+    }
+}
+
+std::string HIDHttpApi::buildStreamAck(std::optional<int64_t> seq) const
+{
+    const auto pointer = hid_.pointerState();
+    std::string json;
+    json.reserve(112);
+    json.append("{\"type\":\"ack\"");
+    if (seq) {
+        json.append(",\"seq\":").append(std::to_string(*seq));
+    }
+    json.append(",\"x\":").append(std::to_string(pointer.x));
+    json.append(",\"y\":").append(std::to_string(pointer.y));
+    json.append(",\"buttons\":").append(std::to_string(pointer.buttons));
+    json.append(",\"queue_depth\":").append(std::to_string(actions_.depth()));
+    json.push_back('}');
+    return json;
+}
+
+std::string HIDHttpApi::buildStreamError(std::optional<int64_t> seq, const std::string& detail) const
+{
+    std::string json;
+    json.reserve(48 + detail.size());
+    json.append("{\"type\":\"error\"");
+    if (seq) {
+        json.append(",\"seq\":").append(std::to_string(*seq));
+    }
+    json.append(",\"detail\":");
+    appendJsonString(json, detail);
+    json.push_back('}');
+    return json;
+}
+
+void HIDHttpApi::publishJobEvent(HIDJobEvent event, const HIDJobSnapshot& job)
+{
+    if (eventSubscribers_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    const auto payload = std::make_shared<const std::string>(buildJobEvent(event, job));
+    for (auto& reactor : reactors_) {
+        if (reactor->hasEventSubscribers()) {
+            reactor->broadcast(job.id, payload);
         }
     }
+}
+
+std::string HIDHttpApi::buildJobEvent(HIDJobEvent event, const HIDJobSnapshot& job)
+{
+    std::string_view name;
+    switch (event) {
+    case HIDJobEvent::Started:
+        name = "started";
+        break;
+    case HIDJobEvent::Progress:
+        name = "progress";
+        break;
+    case HIDJobEvent::Finished:
+        name = job.state == HIDJobState::Succeeded ? "completed" : jobStateName(job.state);
+        break;
+    }
 
-    ::shutdown(clientFd, SHUT_RDWR);
-    ::close(clientFd);
+    std::string text;
+    text.reserve(192 + job.error.size());
+    text.append("id: ").append(std::to_string(nextEventId_.fetch_add(1, std::memory_order_relaxed)));
+    text.append("\nevent: ").append(name);
+    text.append("\ndata: {\"job_id\":").append(std::to_string(job.id));
+    text.append(",\"kind\":");
+    appendJsonString(text, job.kind);
+    switch (event) {
+    case HIDJobEvent::Started:
+        text.append(",\"queued_us\":").append(std::to_string(job.queued.count()));
+        break;
+    case HIDJobEvent::Progress:
+        text.append(",\"done\":").append(std::to_string(job.progressDone));
+        text.append(",\"total\":").append(std::to_string(job.progressTotal));
+        text.append(",\"elapsed_us\":").append(std::to_string(job.running.count()));
+        break;
+    case HIDJobEvent::Finished:
+        text.append(",\"queued_us\":").append(std::to_string(job.queued.count()));
+        text.append(",\"duration_us\":").append(std::to_string(job.running.count()));
+        if (job.state != HIDJobState::Succeeded) {
+            text.append(",\"detail\":");
+            appendJsonString(text, job.error);
+        }
+        break;
+    }
+    text.append("}\n\n");
+    return text;
 }
 
-std::string HIDHttpApi::buildJsonResponse(const std::string& status, const std::string& detail) const
+std::string HIDHttpApi::buildJobResponse(const HIDJobSnapshot& job) const
 {
-    std::ostringstream oss;
-    oss << "{\"status\":\"" << status << "\"";
-    if (!detail.empty()) {
-        oss << ",\"detail\":\"";
-        for (char ch : detail) {
-            switch (ch) {
-            case '"':
-                oss << "\\\"";
-                break;
-            case '\\':
-                oss << "\\\\";
-                break;
-            case '\n':
-                oss << "\\n";
-                break;
-            case '\r':
-                oss << "\\r";
-                break;
-            case '\t':
-                oss << "\\t";
-                break;
-            default:
-                oss << ch;
-            }
+    std::string json;
+    json.reserve(160 + job.result.size() + job.error.size());
+    json.append("{\"job_id\":").append(std::to_string(job.id));
+    json.append(",\"kind\":");
+    appendJsonString(json, job.kind);
+    json.append(",\"priority\":\"").append(priorityName(job.priority));
+    json.append("\",\"state\":\"").append(jobStateName(job.state));
+    json.append("\",\"progress\":{\"done\":").append(std::to_string(job.progressDone));
+    json.append(",\"total\":").append(std::to_string(job.progressTotal));
+    json.append("},\"queued_us\":").append(std::to_string(job.queued.count()));
+    json.append(",\"run_us\":").append(std::to_string(job.running.count()));
+    if (job.state == HIDJobState::Succeeded) {
+        json.append(",\"result\":").append(job.result);
+    } else if (job.finished()) {
+        json.append(",\"detail\":");
+        appendJsonString(json, job.error);
+    }
+    json.push_back('}');
+    return json;
+}
+
+std::string HIDHttpApi::buildBatchResponse(const std::vector<HIDAction>& actions, const std::vector<HIDActionTiming>& timings) const
+{
+    std::string json;
+    json.reserve(64 + timings.size() * 64);
+    json.append("{\"status\":\"ok\",\"total_us\":");
+    const auto total = timings.empty() ? std::chrono::microseconds{0} : timings.back().offset + timings.back().duration;
+    json.append(std::to_string(total.count()));
+    json.append(",\"steps\":[");
+    for (size_t i = 0; i < timings.size(); ++i) {
+        if (i > 0) {
+            json.push_back(',');
         }
-        oss << "\"";
+        json.append("{\"type\":\"").append(actionTypeName(actions[i].type));
+        json.append("\",\"offset_us\":").append(std::to_string(timings[i].offset.count()));
+        json.append(",\"duration_us\":").append(std::to_string(timings[i].duration.count()));
+        json.push_back('}');
     }
-    oss << "}";
-    return oss.str();
+    json.append("]}");
+    return json;
 }
 
-void HIDHttpApi::sendResponse(int clientFd, int statusCode, const std::string& reason, const std::string& body, const std::string& contentType) const
+std::string HIDHttpApi::buildJsonResponse(const std::string& status, const std::string& detail) const
 {
-    std::ostringstream response;
-    response << "HTTP/1.1 " << statusCode << ' ' << reason << "\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << body.size() << "\r\n";
-    response << "Connection: close\r\n\r\n";
-    response << body;
-
-    const auto responseStr = response.str();
-    ::send(clientFd, responseStr.data(), responseStr.size(), 0);
+    std::string json;
+    json.reserve(status.size() + detail.size() + 32);
+    json.append("{\"status\":\"").append(status).append("\"");
+    if (!detail.empty()) {
+        json.append(",\"detail\":");
+        appendJsonString(json, detail);
+    }
+    json.push_back('}');
+    return json;
 }
@@ -0,0 +1,274 @@
+#include "http_codec.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <strings.h>
+
+namespace {
+
+constexpr std::string_view kHeaderTerminator{"\r\n\r\n"};
+constexpr std::string_view kCrlf{"\r\n"};
+constexpr size_t kMinimumBufferGrowth = 4096;
+
+struct StatusTemplate {
+    int code;
+    std::string_view reason;
+    std::string_view statusLine;
+};
+
+constexpr std::array<StatusTemplate, 9> kStatusTemplates{{
+    {200, "OK", "HTTP/1.1 200 OK\r\n"},
+    {202, "Accepted", "HTTP/1.1 202 Accepted\r\n"},
+    {400, "Bad Request", "HTTP/1.1 400 Bad Request\r\n"},
+    {404, "Not Found", "HTTP/1.1 404 Not Found\r\n"},
+    {405, "Method Not Allowed", "HTTP/1.1 405 Method Not Allowed\r\n"},
+    {409, "Conflict", "HTTP/1.1 409 Conflict\r\n"},
+    {413, "Payload Too Large", "HTTP/1.1 413 Payload Too Large\r\n"},
+    {429, "Too Many Requests", "HTTP/1.1 429 Too Many Requests\r\n"},
+    {500, "Internal Server Error", "HTTP/1.1 500 Internal Server Error\r\n"},
+}};
+
+constexpr std::string_view kFallbackStatusLine{"HTTP/1.1 500 Internal Server Error\r\n"};
+constexpr std::string_view kContentTypePrefix{"Content-Type: "};
+constexpr std::string_view kContentLengthPrefix{"\r\nContent-Length: "};
+constexpr std::string_view kKeepAliveSuffix{"Connection: keep-alive\r\n\r\n"};
+constexpr std::string_view kCloseSuffix{"Connection: close\r\n\r\n"};
+
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs)
+{
+    return lhs.size() == rhs.size() && ::strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+std::string_view trimWhitespace(std::string_view value)
+{
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+bool isTokenChar(char ch)
+{
+    return ch > 0x20 && ch < 0x7F && ch != ':';
+}
+
+} // namespace
+
+std::optional<std::string_view> HttpRequestView::header(std::string_view name) const
+{
+    for (size_t i = 0; i < headerCount; ++i) {
+        if (equalsIgnoreCase(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return std::nullopt;
+}
+
+bool HttpRequestView::headerHasToken(std::string_view name, std::string_view token) const
+{
+    for (size_t i = 0; i < headerCount; ++i) {
+        if (!equalsIgnoreCase(headers[i].name, name)) {
+            continue;
+        }
+        auto remaining = headers[i].value;
+        while (!remaining.empty()) {
+            const auto comma = remaining.find(',');
+            if (equalsIgnoreCase(trimWhitespace(remaining.substr(0, comma)), token)) {
+                return true;
+            }
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            remaining.remove_prefix(comma + 1);
+        }
+    }
+    return false;
+}
+
+std::optional<std::string_view> HttpRequestView::queryParam(std::string_view name) const
+{
+    auto remaining = query;
+    while (!remaining.empty()) {
+        const auto amp = remaining.find('&');
+        const auto pair = remaining.substr(0, amp);
+        const auto eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        remaining.remove_prefix(amp + 1);
+    }
+    return std::nullopt;
+}
+
+bool HttpRequestView::wantsKeepAlive() const
+{
+    if (version == "HTTP/1.0") {
+        return headerHasToken("Connection", "keep-alive");
+    }
+    return !headerHasToken("Connection", "close");
+}
+
+HttpParseStatus parseHttpRequest(std::string_view buffer, HttpRequestView& request, size_t& consumed)
+{
+    const auto headerEnd = buffer.find(kHeaderTerminator);
+    if (headerEnd == std::string_view::npos) {
+        return HttpParseStatus::Incomplete;
+    }
+
+    auto head = buffer.substr(0, headerEnd + kCrlf.size());
+
+    const auto lineEnd = head.find(kCrlf);
+    const auto requestLine = head.substr(0, lineEnd);
+    head.remove_prefix(lineEnd + kCrlf.size());
+
+    const auto firstSpace = requestLine.find(' ');
+    const auto secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == 0 || firstSpace == std::string_view::npos || secondSpace == std::string_view::npos) {
+        return HttpParseStatus::Invalid;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    request.target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    request.version = requestLine.substr(secondSpace + 1);
+    if (request.target.empty() || request.version.substr(0, 5) != "HTTP/") {
+        return HttpParseStatus::Invalid;
+    }
+
+    const auto question = request.target.find('?');
+    request.path = request.target.substr(0, question);
+    request.query = question == std::string_view::npos ? std::string_view{} : request.target.substr(question + 1);
+
+    request.headerCount = 0;
+    request.contentLength = 0;
+    bool sawContentLength = false;
+    while (!head.empty()) {
+        const auto end = head.find(kCrlf);
+        const auto line = head.substr(0, end);
+        head.remove_prefix(end + kCrlf.size());
+
+        const auto colon = line.find(':');
+        if (colon == 0 || colon == std::string_view::npos) {
+            return HttpParseStatus::Invalid;
+        }
+        const auto name = line.substr(0, colon);
+        if (!std::all_of(name.begin(), name.end(), isTokenChar)) {
+            return HttpParseStatus::Invalid;
+        }
+        if (request.headerCount == HttpRequestView::kMaxHeaders) {
+            return HttpParseStatus::Invalid;
+        }
+        const auto value = trimWhitespace(line.substr(colon + 1));
+        request.headers[request.headerCount++] = {name, value};
+
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            // A repeated Content-Length, even with the same value, is treated
+            // as invalid framing (RFC 9112 §6.3) rather than picking one.
+            if (sawContentLength) {
+                return HttpParseStatus::Invalid;
+            }
+            sawContentLength = true;
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), request.contentLength);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                return HttpParseStatus::Invalid;
+            }
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            return HttpParseStatus::Invalid;
+        }
+    }
+
+    const auto bodyStart = headerEnd + kHeaderTerminator.size();
+    if (buffer.size() - bodyStart < request.contentLength) {
+        return HttpParseStatus::Incomplete;
+    }
+
+    request.body = buffer.substr(bodyStart, request.contentLength);
+    consumed = bodyStart + request.contentLength;
+    return HttpParseStatus::Complete;
+}
+
+char* HttpBuffer::prepare(size_t minimum)
+{
+    if (data_.size() - end_ >= minimum) {
+        return data_.data() + end_;
+    }
+    if (begin_ > 0) {
+        std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (data_.size() - end_ < minimum) {
+        data_.resize(std::max(data_.size() * 2, end_ + std::max(minimum, kMinimumBufferGrowth)));
+    }
+    return data_.data() + end_;
+}
+
+void HttpBuffer::append(std::string_view bytes)
+{
+    std::memcpy(prepare(bytes.size()), bytes.data(), bytes.size());
+    commit(bytes.size());
+}
+
+void HttpBuffer::consume(size_t count) noexcept
+{
+    begin_ += std::min(count, end_ - begin_);
+    if (begin_ == end_) {
+        begin_ = end_ = 0;
+    }
+}
+
+void HttpResponseHead::format(int statusCode, std::string_view contentType, size_t contentLength, bool keepAlive,
+                              std::string_view extraHeaders)
+{
+    auto statusLine = kFallbackStatusLine;
+    for (const auto& entry : kStatusTemplates) {
+        if (entry.code == statusCode) {
+            statusLine = entry.statusLine;
+            break;
+        }
+    }
+    char digits[24];
+    const auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), contentLength);
+    (void)ec;
+    const std::string_view length{digits, static_cast<size_t>(end - digits)};
+    const auto suffix = keepAlive ? kKeepAliveSuffix : kCloseSuffix;
+
+    const auto total = statusLine.size() + kContentTypePrefix.size() + contentType.size() + kContentLengthPrefix.size() +
+                       length.size() + kCrlf.size() + extraHeaders.size() + suffix.size();
+    size_ = 0;
+    overflow_.clear();
+    if (total > kCapacity) {
+        overflow_.resize(total);
+    }
+
+    append(statusLine);
+    append(kContentTypePrefix);
+    append(contentType);
+    append(kContentLengthPrefix);
+    append(length);
+    append(kCrlf);
+    append(extraHeaders);
+    append(suffix);
+}
+
+void HttpResponseHead::append(std::string_view bytes) noexcept
+{
+    auto* target = overflow_.empty() ? buffer_.data() : overflow_.data();
+    std::memcpy(target + size_, bytes.data(), bytes.size());
+    size_ += bytes.size();
+}
+
+std::string_view httpStatusText(int statusCode)
+{
+    for (const auto& entry : kStatusTemplates) {
+        if (entry.code == statusCode) {
+            return entry.reason;
+        }
+    }
+    return "Error";
+}
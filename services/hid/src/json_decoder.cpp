@@ -0,0 +1,645 @@
+#include "json_decoder.hpp"
+
+#include <charconv>
+#include <limits>
+
+namespace {
+
+constexpr int64_t kMaxCoordinate = 65535;
+constexpr int64_t kMaxWaitMs = 10000;
+constexpr size_t kMaxBatchActions = 256;
+constexpr int64_t kMaxWheelDelta = 1024;
+constexpr size_t kMaxCalibrationSamples = 127;
+
+class FieldSet {
+public:
+    explicit FieldSet(JsonReader& reader) : reader_(reader) {}
+
+    // Marks a field as seen; duplicates are rejected rather than last-wins.
+    void claim(bool& seen)
+    {
+        if (seen) {
+            reader_.rejectField("duplicate field");
+        }
+        seen = true;
+    }
+
+    [[noreturn]] void unknown() { reader_.rejectField("unknown field"); }
+
+private:
+    JsonReader& reader_;
+};
+
+void requireField(bool seen, const char* field, std::string_view json)
+{
+    if (!seen) {
+        throw JsonDecodeError(std::string{"Missing required field '"} + field + "'", json.size());
+    }
+}
+
+MouseButton readMouseButton(JsonReader& reader)
+{
+    const auto name = reader.readString();
+    try {
+        return mouseButtonFromString(name);
+    } catch (const std::invalid_argument&) {
+        reader.fail("unsupported mouse button '" + name + "'");
+    }
+}
+
+PointerCommand decodePointerCommand(std::string_view json, bool allowButton)
+{
+    JsonReader reader(json);
+    PointerCommand command;
+    bool hasX = false;
+    bool hasY = false;
+    bool hasButton = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "x") {
+            fields.claim(hasX);
+            command.x = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (field == "y") {
+            fields.claim(hasY);
+            command.y = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (allowButton && field == "button") {
+            fields.claim(hasButton);
+            command.button = readMouseButton(reader);
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasX, "x", json);
+    requireField(hasY, "y", json);
+    return command;
+}
+
+HIDAction decodeBatchAction(JsonReader& reader, size_t index)
+{
+    const auto fail = [&reader, index](const std::string& message) {
+        reader.fail("actions[" + std::to_string(index) + "]: " + message);
+    };
+
+    HIDAction action;
+    bool hasType = false;
+    bool hasX = false;
+    bool hasY = false;
+    bool hasButton = false;
+    bool hasText = false;
+    bool hasWait = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "type") {
+            fields.claim(hasType);
+            const auto name = reader.readString();
+            try {
+                action.type = actionTypeFromString(name);
+            } catch (const std::invalid_argument&) {
+                fail("unsupported action type '" + name + "'");
+            }
+        } else if (field == "x") {
+            fields.claim(hasX);
+            action.x = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (field == "y") {
+            fields.claim(hasY);
+            action.y = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (field == "button") {
+            fields.claim(hasButton);
+            action.button = readMouseButton(reader);
+        } else if (field == "text") {
+            fields.claim(hasText);
+            action.text = reader.readString();
+        } else if (field == "ms") {
+            fields.claim(hasWait);
+            action.waitMs = static_cast<uint32_t>(reader.readInteger(0, kMaxWaitMs));
+        } else {
+            fields.unknown();
+        }
+    }
+
+    if (!hasType) {
+        fail("missing field 'type'");
+    }
+
+    const bool pointer = action.type == HIDActionType::Click || action.type == HIDActionType::Move;
+    const auto typeName = std::string{actionTypeName(action.type)};
+    if (pointer && (!hasX || !hasY)) {
+        fail("'" + typeName + "' requires fields 'x' and 'y'");
+    }
+    if (!pointer && (hasX || hasY)) {
+        fail("fields 'x' and 'y' are not valid for '" + typeName + "'");
+    }
+    if (hasButton && action.type != HIDActionType::Click) {
+        fail("field 'button' is only valid for 'click'");
+    }
+    if (hasText != (action.type == HIDActionType::Text)) {
+        fail(hasText ? "field 'text' is only valid for 'text'" : "'text' requires field 'text'");
+    }
+    if (hasWait != (action.type == HIDActionType::Wait)) {
+        fail(hasWait ? "field 'ms' is only valid for 'wait'" : "'wait' requires field 'ms'");
+    }
+    return action;
+}
+
+} // namespace
+
+JsonDecodeError::JsonDecodeError(const std::string& message, size_t offset)
+    : std::invalid_argument(message)
+    , offset_(offset)
+{
+}
+
+void JsonReader::beginObject()
+{
+    skipWhitespace();
+    expect('{');
+    atContainerStart_ = true;
+}
+
+bool JsonReader::nextField(std::string_view& name)
+{
+    field_ = {};
+    skipWhitespace();
+    if (atContainerStart_) {
+        atContainerStart_ = false;
+        if (consumeIf('}')) {
+            return false;
+        }
+    } else {
+        if (consumeIf('}')) {
+            return false;
+        }
+        expect(',');
+        skipWhitespace();
+    }
+
+    if (pos_ >= input_.size() || input_[pos_] != '"') {
+        fail("expected field name");
+    }
+    const auto start = ++pos_;
+    while (pos_ < input_.size() && input_[pos_] != '"') {
+        if (input_[pos_] == '\\' || static_cast<unsigned char>(input_[pos_]) < 0x20) {
+            fail("unsupported character in field name");
+        }
+        ++pos_;
+    }
+    if (pos_ >= input_.size()) {
+        fail("unterminated field name");
+    }
+    name = input_.substr(start, pos_ - start);
+    ++pos_;
+
+    skipWhitespace();
+    expect(':');
+    skipWhitespace();
+    field_ = name;
+    return true;
+}
+
+void JsonReader::beginArray()
+{
+    skipWhitespace();
+    expect('[');
+    atContainerStart_ = true;
+}
+
+bool JsonReader::nextElement()
+{
+    skipWhitespace();
+    if (atContainerStart_) {
+        atContainerStart_ = false;
+        return !consumeIf(']');
+    }
+    if (consumeIf(']')) {
+        return false;
+    }
+    expect(',');
+    skipWhitespace();
+    return true;
+}
+
+std::string JsonReader::readString()
+{
+    skipWhitespace();
+    if (pos_ >= input_.size() || input_[pos_] != '"') {
+        fail("expected a string");
+    }
+    ++pos_;
+
+    std::string out;
+    while (true) {
+        const auto start = pos_;
+        while (pos_ < input_.size() && input_[pos_] != '"' && input_[pos_] != '\\' && static_cast<unsigned char>(input_[pos_]) >= 0x20) {
+            ++pos_;
+        }
+        out.append(input_.substr(start, pos_ - start));
+        if (pos_ >= input_.size()) {
+            fail("unterminated string");
+        }
+
+        const char ch = input_[pos_];
+        if (ch == '"') {
+            ++pos_;
+            return out;
+        }
+        if (ch != '\\') {
+            fail("control character in string");
+        }
+        if (++pos_ >= input_.size()) {
+            fail("unterminated escape sequence");
+        }
+        switch (input_[pos_++]) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            uint32_t codepoint = readHex4();
+            if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                if (input_.substr(pos_, 2) != "\\u") {
+                    fail("unpaired surrogate in \\u escape");
+                }
+                pos_ += 2;
+                const uint32_t low = readHex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    fail("invalid low surrogate in \\u escape");
+                }
+                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                fail("unpaired surrogate in \\u escape");
+            }
+            appendUtf8(out, codepoint);
+            break;
+        }
+        default:
+            --pos_;
+            fail("invalid escape sequence");
+        }
+    }
+}
+
+int64_t JsonReader::readInteger(int64_t min, int64_t max)
+{
+    skipWhitespace();
+    const auto start = pos_;
+    if (pos_ < input_.size() && input_[pos_] == '-') {
+        ++pos_;
+    }
+    const auto digitsStart = pos_;
+    while (pos_ < input_.size() && input_[pos_] >= '0' && input_[pos_] <= '9') {
+        ++pos_;
+    }
+    if (pos_ == digitsStart) {
+        pos_ = start;
+        fail("expected an integer");
+    }
+    if (input_[digitsStart] == '0' && pos_ - digitsStart > 1) {
+        pos_ = start;
+        fail("leading zeros are not allowed");
+    }
+    if (pos_ < input_.size() && (input_[pos_] == '.' || input_[pos_] == 'e' || input_[pos_] == 'E')) {
+        pos_ = start;
+        fail("expected an integer");
+    }
+
+    int64_t value = 0;
+    const auto [ptr, ec] = std::from_chars(input_.data() + start, input_.data() + pos_, value);
+    if (ec != std::errc{} || value < min || value > max) {
+        pos_ = start;
+        fail("integer out of range [" + std::to_string(min) + ", " + std::to_string(max) + "]");
+    }
+    (void)ptr;
+    return value;
+}
+
+bool JsonReader::readBool()
+{
+    skipWhitespace();
+    if (input_.substr(pos_, 4) == "true") {
+        pos_ += 4;
+        return true;
+    }
+    if (input_.substr(pos_, 5) == "false") {
+        pos_ += 5;
+        return false;
+    }
+    fail("expected a boolean");
+}
+
+void JsonReader::finish()
+{
+    field_ = {};
+    skipWhitespace();
+    if (pos_ != input_.size()) {
+        fail("unexpected trailing content");
+    }
+}
+
+void JsonReader::fail(const std::string& message) const
+{
+    if (field_.empty()) {
+        throw JsonDecodeError("Invalid JSON at offset " + std::to_string(pos_) + ": " + message, pos_);
+    }
+    throw JsonDecodeError("Invalid value for field '" + std::string{field_} + "' at offset " + std::to_string(pos_) + ": " + message, pos_);
+}
+
+void JsonReader::rejectField(std::string_view reason) const
+{
+    throw JsonDecodeError("Invalid JSON at offset " + std::to_string(pos_) + ": " + std::string{reason} + " '" + std::string{field_} + "'", pos_);
+}
+
+void JsonReader::skipWhitespace() noexcept
+{
+    while (pos_ < input_.size() && (input_[pos_] == ' ' || input_[pos_] == '\t' || input_[pos_] == '\n' || input_[pos_] == '\r')) {
+        ++pos_;
+    }
+}
+
+void JsonReader::expect(char ch)
+{
+    if (!consumeIf(ch)) {
+        fail(std::string{"expected '"} + ch + "'");
+    }
+}
+
+bool JsonReader::consumeIf(char ch)
+{
+    if (pos_ < input_.size() && input_[pos_] == ch) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+void JsonReader::appendUtf8(std::string& out, uint32_t codepoint) const
+{
+    if (codepoint < 0x80) {
+        out.push_back(static_cast<char>(codepoint));
+    } else if (codepoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else if (codepoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+uint32_t JsonReader::readHex4()
+{
+    if (pos_ + 4 > input_.size()) {
+        fail("truncated \\u escape");
+    }
+    uint32_t value = 0;
+    const auto [ptr, ec] = std::from_chars(input_.data() + pos_, input_.data() + pos_ + 4, value, 16);
+    if (ec != std::errc{} || ptr != input_.data() + pos_ + 4) {
+        fail("invalid \\u escape");
+    }
+    pos_ += 4;
+    return value;
+}
+
+TextCommand decodeTextCommand(std::string_view json)
+{
+    JsonReader reader(json);
+    TextCommand command;
+    bool hasText = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "text") {
+            fields.claim(hasText);
+            command.text = reader.readString();
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasText, "text", json);
+    return command;
+}
+
+PointerCommand decodeClickCommand(std::string_view json)
+{
+    return decodePointerCommand(json, true);
+}
+
+PointerCommand decodeMoveCommand(std::string_view json)
+{
+    return decodePointerCommand(json, false);
+}
+
+std::vector<HIDAction> decodeBatchCommand(std::string_view json)
+{
+    JsonReader reader(json);
+    std::vector<HIDAction> actions;
+    bool hasActions = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "actions") {
+            fields.claim(hasActions);
+            reader.beginArray();
+            while (reader.nextElement()) {
+                if (actions.size() == kMaxBatchActions) {
+                    reader.fail("batch exceeds " + std::to_string(kMaxBatchActions) + " actions");
+                }
+                actions.push_back(decodeBatchAction(reader, actions.size()));
+            }
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasActions, "actions", json);
+    if (actions.empty()) {
+        throw JsonDecodeError("Batch must contain at least one action", json.size());
+    }
+    return actions;
+}
+
+StreamMessage decodeStreamMessage(std::string_view json)
+{
+    JsonReader reader(json);
+    StreamMessage message;
+    bool hasType = false;
+    bool hasSeq = false;
+    bool hasX = false;
+    bool hasY = false;
+    bool hasButton = false;
+    bool hasPressed = false;
+    bool hasDelta = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "type") {
+            fields.claim(hasType);
+            const auto name = reader.readString();
+            if (name == "move") {
+                message.type = StreamMessageType::Move;
+            } else if (name == "button") {
+                message.type = StreamMessageType::Button;
+            } else if (name == "wheel") {
+                message.type = StreamMessageType::Wheel;
+            } else {
+                reader.fail("unsupported message type '" + name + "'");
+            }
+        } else if (field == "seq") {
+            fields.claim(hasSeq);
+            message.seq = reader.readInteger(0, std::numeric_limits<int64_t>::max());
+        } else if (field == "x") {
+            fields.claim(hasX);
+            message.x = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (field == "y") {
+            fields.claim(hasY);
+            message.y = static_cast<int>(reader.readInteger(-kMaxCoordinate, kMaxCoordinate));
+        } else if (field == "button") {
+            fields.claim(hasButton);
+            message.button = readMouseButton(reader);
+        } else if (field == "pressed") {
+            fields.claim(hasPressed);
+            message.pressed = reader.readBool();
+        } else if (field == "delta") {
+            fields.claim(hasDelta);
+            message.delta = static_cast<int>(reader.readInteger(-kMaxWheelDelta, kMaxWheelDelta));
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasType, "type", json);
+    const auto reject = [&json](const char* message) { throw JsonDecodeError(message, json.size()); };
+    switch (message.type) {
+    case StreamMessageType::Move:
+        if (!hasX || !hasY || hasButton || hasPressed || hasDelta) {
+            reject("'move' takes exactly fields 'x' and 'y'");
+        }
+        break;
+    case StreamMessageType::Button:
+        if (!hasButton || !hasPressed || hasX || hasY || hasDelta) {
+            reject("'button' takes exactly fields 'button' and 'pressed'");
+        }
+        break;
+    case StreamMessageType::Wheel:
+        if (!hasDelta || hasX || hasY || hasButton || hasPressed) {
+            reject("'wheel' takes exactly field 'delta'");
+        }
+        break;
+    }
+    return message;
+}
+
+CalibrationCommand decodeCalibrationCommand(std::string_view json)
+{
+    JsonReader reader(json);
+    CalibrationCommand command;
+    bool hasHost = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "host") {
+            fields.claim(hasHost);
+            command.host = reader.readString();
+            if (!isValidCalibrationHost(command.host)) {
+                reader.fail("host must be 1-64 characters of [A-Za-z0-9._-]");
+            }
+        } else if (field == "samples") {
+            if (command.samples) {
+                reader.rejectField("duplicate field");
+            }
+            auto& samples = command.samples.emplace();
+            reader.beginArray();
+            while (reader.nextElement()) {
+                if (samples.size() == kMaxCalibrationSamples) {
+                    reader.fail("calibration exceeds " + std::to_string(kMaxCalibrationSamples) + " samples");
+                }
+                HIDGainSample sample;
+                bool hasStep = false;
+                bool hasReports = false;
+                bool hasPixels = false;
+                FieldSet sampleFields(reader);
+                reader.beginObject();
+                while (reader.nextField(field)) {
+                    if (field == "step") {
+                        sampleFields.claim(hasStep);
+                        sample.step = static_cast<int>(reader.readInteger(1, HIDPointerCalibration::kMaxStep));
+                    } else if (field == "reports") {
+                        sampleFields.claim(hasReports);
+                        sample.reports = static_cast<int>(reader.readInteger(1, HIDPointerCalibration::kMaxProbeReports));
+                    } else if (field == "pixels") {
+                        sampleFields.claim(hasPixels);
+                        sample.pixels = static_cast<int>(reader.readInteger(1, HIDPointerCalibration::kMaxProbePixels));
+                    } else {
+                        sampleFields.unknown();
+                    }
+                }
+                if (!hasStep || !hasReports || !hasPixels) {
+                    reader.fail("samples[" + std::to_string(samples.size()) + "] requires fields 'step', 'reports' and 'pixels'");
+                }
+                samples.push_back(sample);
+            }
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasHost, "host", json);
+    return command;
+}
+
+ProbeCommand decodeProbeCommand(std::string_view json)
+{
+    JsonReader reader(json);
+    ProbeCommand command;
+    bool hasStep = false;
+    bool hasReports = false;
+    FieldSet fields(reader);
+
+    reader.beginObject();
+    std::string_view field;
+    while (reader.nextField(field)) {
+        if (field == "step") {
+            fields.claim(hasStep);
+            command.step = static_cast<int>(reader.readInteger(1, HIDPointerCalibration::kMaxStep));
+        } else if (field == "reports") {
+            fields.claim(hasReports);
+            command.reports = static_cast<int>(reader.readInteger(1, HIDPointerCalibration::kMaxProbeReports));
+        } else {
+            fields.unknown();
+        }
+    }
+    reader.finish();
+
+    requireField(hasStep, "step", json);
+    requireField(hasReports, "reports", json);
+    return command;
+}
@@ -1,5 +1,6 @@
 #include "bluetooth_hid_server.hpp"
 #include "hid_config.hpp"
+#include "hid_datagram.hpp"
 #include "http_api.hpp"
 
 #include <atomic>
@@ -40,11 +41,15 @@ int main(int argc, char** argv)
         HIDHttpApi httpServer(hid, config);
         httpServer.start();
 
+        HIDDatagramServer datagramServer(hid, config);
+        datagramServer.start();
+
         std::signal(SIGINT, handleSignal);
         std::signal(SIGTERM, handleSignal);
 
         shutdownPromise.get_future().wait();
 
+        datagramServer.stop();
         httpServer.stop();
         hid.stop();
 
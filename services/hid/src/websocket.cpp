@@ -0,0 +1,207 @@
+#include "websocket.hpp"
+
+namespace {
+
+constexpr std::string_view kHandshakeGuid{"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+constexpr std::string_view kBase64Alphabet{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+constexpr size_t kMaxControlPayload = 125;
+
+uint32_t rotateLeft(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// SHA-1 is only used for the handshake accept key, so a compact byte-wise
+// implementation is sufficient.
+std::array<uint8_t, 20> sha1(std::string_view input)
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string message{input};
+    const uint64_t bitLength = static_cast<uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        message.push_back(static_cast<char>((bitLength >> shift) & 0xFF));
+    }
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(message.data() + chunk + i * 4);
+            w[i] = (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) | (uint32_t{bytes[2]} << 8) | uint32_t{bytes[3]};
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f;
+            uint32_t k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest{};
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+    return digest;
+}
+
+std::string base64Encode(const uint8_t* data, size_t size)
+{
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        const uint32_t octets = (uint32_t{data[i]} << 16) | (i + 1 < size ? uint32_t{data[i + 1]} << 8 : 0) | (i + 2 < size ? uint32_t{data[i + 2]} : 0);
+        out.push_back(kBase64Alphabet[(octets >> 18) & 0x3F]);
+        out.push_back(kBase64Alphabet[(octets >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? kBase64Alphabet[(octets >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? kBase64Alphabet[octets & 0x3F] : '=');
+    }
+    return out;
+}
+
+} // namespace
+
+WebSocketParseStatus parseWebSocketFrame(std::string_view buffer, WebSocketFrame& frame, size_t& consumed)
+{
+    if (buffer.size() < 2) {
+        return WebSocketParseStatus::Incomplete;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(buffer.data());
+    if ((bytes[0] & 0x70) != 0 || (bytes[1] & 0x80) == 0) {
+        return WebSocketParseStatus::Invalid;
+    }
+
+    frame.fin = (bytes[0] & 0x80) != 0;
+    frame.opcode = static_cast<WebSocketOpcode>(bytes[0] & 0x0F);
+    switch (frame.opcode) {
+    case WebSocketOpcode::Continuation:
+    case WebSocketOpcode::Text:
+    case WebSocketOpcode::Binary:
+    case WebSocketOpcode::Close:
+    case WebSocketOpcode::Ping:
+    case WebSocketOpcode::Pong:
+        break;
+    default:
+        return WebSocketParseStatus::Invalid;
+    }
+
+    size_t offset = 2;
+    uint64_t length = bytes[1] & 0x7F;
+    if (length == 126 || length == 127) {
+        const size_t extended = length == 126 ? 2 : 8;
+        if (buffer.size() < offset + extended) {
+            return WebSocketParseStatus::Incomplete;
+        }
+        length = 0;
+        for (size_t i = 0; i < extended; ++i) {
+            length = (length << 8) | bytes[offset + i];
+        }
+        offset += extended;
+        if ((length >> 63) != 0) {
+            return WebSocketParseStatus::Invalid;
+        }
+    }
+
+    const bool control = (static_cast<uint8_t>(frame.opcode) & 0x08) != 0;
+    if (control && (!frame.fin || length > kMaxControlPayload)) {
+        return WebSocketParseStatus::Invalid;
+    }
+
+    if (buffer.size() < offset + 4) {
+        return WebSocketParseStatus::Incomplete;
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        frame.mask[i] = bytes[offset + i];
+    }
+    offset += 4;
+
+    if (buffer.size() - offset < length) {
+        return WebSocketParseStatus::Incomplete;
+    }
+    frame.payload = buffer.substr(offset, static_cast<size_t>(length));
+    consumed = offset + static_cast<size_t>(length);
+    return WebSocketParseStatus::Complete;
+}
+
+void unmaskWebSocketPayload(const WebSocketFrame& frame, std::string& out)
+{
+    out.resize(frame.payload.size());
+    for (size_t i = 0; i < frame.payload.size(); ++i) {
+        out[i] = static_cast<char>(static_cast<uint8_t>(frame.payload[i]) ^ frame.mask[i & 3]);
+    }
+}
+
+WebSocketFrameHeader::WebSocketFrameHeader(WebSocketOpcode opcode, size_t payloadSize) noexcept
+{
+    buffer_[0] = static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+    if (payloadSize < 126) {
+        buffer_[1] = static_cast<char>(payloadSize);
+        size_ = 2;
+    } else if (payloadSize <= 0xFFFF) {
+        buffer_[1] = 126;
+        buffer_[2] = static_cast<char>(payloadSize >> 8);
+        buffer_[3] = static_cast<char>(payloadSize & 0xFF);
+        size_ = 4;
+    } else {
+        buffer_[1] = 127;
+        for (int i = 0; i < 8; ++i) {
+            buffer_[2 + i] = static_cast<char>((static_cast<uint64_t>(payloadSize) >> (56 - i * 8)) & 0xFF);
+        }
+        size_ = 10;
+    }
+}
+
+std::string webSocketAcceptKey(std::string_view clientKey)
+{
+    std::string input;
+    input.reserve(clientKey.size() + kHandshakeGuid.size());
+    input.append(clientKey).append(kHandshakeGuid);
+    const auto digest = sha1(input);
+    return base64Encode(digest.data(), digest.size());
+}
+
+std::string webSocketHandshakeResponse(std::string_view clientKey)
+{
+    std::string response;
+    response.reserve(160);
+    response.append("HTTP/1.1 101 Switching Protocols\r\n"
+                    "Upgrade: websocket\r\n"
+                    "Connection: Upgrade\r\n"
+                    "Sec-WebSocket-Accept: ");
+    response.append(webSocketAcceptKey(clientKey));
+    response.append("\r\n\r\n");
+    return response;
+}
@@ -0,0 +1,143 @@
+// Checks that the per-report emission path allocates nothing once warm:
+// ring push and pop, then HIDCharacteristicValue::update(), the same call
+// GattCharacteristic::updateValue() makes to store the value and write the
+// PropertiesChanged body. Creating and sending the sd-bus message itself
+// happens in libsystemd and is not covered. tests/test_hid_report_emission.py
+// builds and runs this under pytest.
+//
+//   jadeai-hid-report-emission-test
+
+#include "hid_gatt_signal.hpp"
+#include "hid_reports.hpp"
+#include "hid_report_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> gAllocations{0};
+
+} // namespace
+
+// Out-of-line so the compiler does not pair the inlined malloc/free itself.
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+constexpr size_t kIterations = 10000;
+
+// Writes the marshalled signal as text into a fixed buffer, one token per
+// call, so the test can check the layout without allocating itself.
+class RecordingMessage {
+public:
+    RecordingMessage& operator<<(const std::string& value)
+    {
+        return put("\"").put(value).put("\" ");
+    }
+
+    RecordingMessage& operator<<(uint8_t value)
+    {
+        constexpr std::string_view kDigits{"0123456789abcdef"};
+        const char hex[] = {kDigits[value >> 4], kDigits[value & 0x0F], ' '};
+        return put({hex, sizeof(hex)});
+    }
+
+    RecordingMessage& openContainer(const std::string& signature) { return put("a").put(signature).put("[ "); }
+    RecordingMessage& closeContainer() { return put("] "); }
+    RecordingMessage& openDictEntry(const std::string& signature) { return put("{").put(signature).put(" "); }
+    RecordingMessage& closeDictEntry() { return put("} "); }
+    RecordingMessage& openVariant(const std::string& signature) { return put("v").put(signature).put("( "); }
+    RecordingMessage& closeVariant() { return put(") "); }
+
+    void clear() noexcept { size_ = 0; }
+    [[nodiscard]] std::string_view text() const noexcept { return {buffer_, size_}; }
+
+private:
+    RecordingMessage& put(std::string_view token)
+    {
+        const size_t count = std::min(token.size(), sizeof(buffer_) - size_);
+        std::copy_n(token.data(), count, buffer_ + size_);
+        size_ += count;
+        return *this;
+    }
+
+    char buffer_[256]{};
+    size_t size_{0};
+};
+
+bool expect(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+    }
+    return condition;
+}
+
+} // namespace
+
+int main()
+{
+    const HIDValueChangedSignal signal{"org.freedesktop.DBus.Properties", "org.bluez.GattCharacteristic1"};
+    auto ring = std::make_unique<HIDReportRing>();
+    HIDCharacteristicValue value;
+    value.reserve(HIDReportRecord{}.bytes.size());
+    RecordingMessage message;
+
+    const auto report = makeKeyboardReport(0x02, 0x04);
+    HIDReportRecord record;
+    record.channel = HIDReportChannel::Keyboard;
+    record.size = static_cast<uint8_t>(report.size());
+    std::copy(report.begin(), report.end(), record.bytes.begin());
+
+    const auto emit = [&]() {
+        HIDReportRecord popped;
+        ring->push(record);
+        ring->pop(popped);
+        message.clear();
+        value.update(popped.bytes.data(), popped.size, signal, &message);
+        ring->retire();
+    };
+
+    emit();
+    const size_t before = gAllocations.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kIterations; ++i) {
+        emit();
+    }
+    const size_t allocations = gAllocations.load(std::memory_order_relaxed) - before;
+
+    bool ok = true;
+    ok &= expect(allocations == 0, "report emission allocated");
+    const auto stored = value.get();
+    ok &= expect(std::equal(stored.begin(), stored.end(), report.begin(), report.end()), "stored value differs from the report");
+    ok &= expect(message.text() == "\"org.bluez.GattCharacteristic1\" a{sv}[ {sv \"Value\" vay( ay[ 01 02 00 04 00 00 00 00 00 ] ) } ] as[ ] ",
+                 "unexpected PropertiesChanged body");
+    ring->close();
+
+    std::printf("%zu reports, %zu allocations\n", kIterations, allocations);
+    return ok ? 0 : 1;
+}
@@ -24,17 +24,42 @@ def test_hid_config_defaults() -> None:
     http_cfg = data["http"]
     assert _resolve(http_cfg["bind"]) == "0.0.0.0"
     assert int(_resolve(http_cfg["port"])) == 8003
+    assert int(_resolve(http_cfg["reactor_threads"])) >= 1
+    assert _resolve(http_cfg["tcp_enabled"]) in {"true", "True", True}
+    assert int(str(_resolve(http_cfg["unix_socket_mode"])).strip('"'), 8) <= 0o777
 
     hid_section = data["hid"]
     assert int(_resolve(hid_section["appearance"])) == 961
     assert _resolve(hid_section["manufacturer"]) == "JadeAI"
     assert _resolve(hid_section["keyboard"]["enabled"]) in {"true", "True", True}
+    assert _resolve(hid_section["keyboard"]["layout"]) in {"us", "uk", "de", "fr"}
+    assert int(_resolve(hid_section["keyboard"]["text_cache_bytes"])) >= 0
     assert _resolve(hid_section["mouse"]["enabled"]) in {"true", "True", True}
+    assert _resolve(hid_section["mouse"]["mode"]) in {"relative", "absolute"}
+    assert int(_resolve(hid_section["mouse"]["screen_width"])) > 0
+    assert int(_resolve(hid_section["mouse"]["screen_height"])) > 0
 
     safety = data["safety"]
     assert int(_resolve(safety["keypress_delay_ms"])) > 0
     assert int(_resolve(safety["mouse_move_delay_ms"])) > 0
     assert int(_resolve(safety["mouse_step_limit"])) > 0
+    assert _resolve(safety["pointer_profile"]) in {"linear", "minimum_jerk"}
+    assert str(_resolve(safety["adaptive_pacing"])).lower() in {"true", "false", "1", "0"}
+    assert int(_resolve(safety["min_report_interval_us"])) > 0
+
+    datagram = data["datagram"]
+    assert _resolve(datagram["bind"]) == "127.0.0.1"
+    assert 0 <= int(_resolve(datagram["udp_port"])) <= 65535
+
+    jobs = data["jobs"]
+    assert int(_resolve(jobs["retain_finished"])) > 0
+    assert int(_resolve(jobs["max_wait_ms"])) > 0
+    assert int(_resolve(jobs["max_queue_depth"])) >= 0
+    assert int(_resolve(jobs["max_queue_delay_ms"])) >= 0
+
+    calibration = data["calibration"]
+    assert "directory" in calibration
+    assert "host" in calibration
 
 
 def _parse_simple_yaml(text: str) -> dict[str, object]:
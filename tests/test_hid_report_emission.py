@@ -0,0 +1,40 @@
+from __future__ import annotations
+
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+HID_DIR = Path("services/hid")
+SOURCES = [
+    "tests/report_emission_test.cpp",
+    "src/hid_metrics.cpp",
+    "src/hid_report_ring.cpp",
+    "src/hid_reports.cpp",
+]
+
+
+def test_hid_report_emission_does_not_allocate(tmp_path: Path) -> None:
+    compiler = shutil.which("g++") or shutil.which("clang++")
+    if compiler is None:
+        pytest.skip("no C++ compiler available")
+
+    binary = tmp_path / "report_emission_test"
+    subprocess.run(
+        [
+            compiler,
+            "-std=c++20",
+            "-O2",
+            f"-I{HID_DIR / 'include'}",
+            *(str(HID_DIR / source) for source in SOURCES),
+            "-pthread",
+            "-o",
+            str(binary),
+        ],
+        check=True,
+    )
+
+    result = subprocess.run([str(binary)], capture_output=True, text=True)
+    assert result.returncode == 0, result.stderr
+    assert "0 allocations" in result.stdout